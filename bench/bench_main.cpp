@@ -0,0 +1,400 @@
+// ElectroSim_bench — headless throughput sweep of the physics core.
+//
+//   ElectroSim_bench [--n 100,1000,10000,100000,1000000] [--solver naive,bh,pm]
+//                    [--threads 1,0] [--min-time 0.5] [--max-pairs 2e10]
+//                    [--format json|csv] [--out file] [--label text] [--broadphase] [--field]
+//                    [--theta 0.5] [--error]
+//
+// One case per (solver, threads, n). Each case builds the same seeded random
+// gas, takes a warm-up step, then steps until --min-time has passed. Cases whose
+// estimated pair work per step exceeds --max-pairs are skipped (naive at 1e6
+// would need 5e11 pair evaluations per step). threads = 0 means all cores.
+//
+// --broadphase times only the collision broad + narrow phase instead of full
+// steps (solver "broad-phase"; particles drift freely between timed calls) at
+// constant density, to show its cost per particle staying flat as N grows.
+//
+// --error also compares each case's forces with the exact pairwise sum
+// (Simulator::measureForceError, up to 1000 sampled rows) after timing, at the
+// Barnes–Hut opening angle --theta.
+//
+// --field times full FieldMap refreshes (potential + E on the app's 100 x 75
+// overlay grid, solver "field-map"); ns_per_pair is per sample-charge pair.
+#include "Simulator.hpp"
+#include "FieldMap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct Options {
+    std::vector<size_t>            counts  = { 100, 1000, 10000, 100000, 1000000 };
+    std::vector<Simulator::Solver> solvers = { Simulator::Solver::Naive, Simulator::Solver::BarnesHut };
+    std::vector<unsigned>          threads = { 1, 0 };
+    double minTime  = 0.5;    // s of timed stepping per case
+    double maxPairs = 2e10;   // skip cases above this many pair evaluations per step
+    bool   csv = false;
+    bool   broadPhase = false;
+    bool   field = false;
+    bool   error = false;
+    float  theta = 0.5f;     // Barnes–Hut opening angle
+    std::string out, label;
+};
+
+struct Result {
+    const char* solver;
+    unsigned threads;        // resolved
+    size_t n;
+    int steps;
+    double seconds;
+    double stepsPerSec;
+    double nsPerPair;        // wall time / (steps * N(N-1)/2), comparable across solvers
+    double nsPerParticle;    // wall time / (steps * N)
+    size_t rssBytes, peakRssBytes;
+    double errRms = -1.0, errMax = -1.0; // relative force error vs. exact, -1 if not measured
+};
+
+const char* solverName(Simulator::Solver s) {
+    switch (s) {
+        case Simulator::Solver::Naive:     return "naive";
+        case Simulator::Solver::BarnesHut: return "barnes-hut";
+        case Simulator::Solver::ParticleMesh: return "particle-mesh";
+    }
+    return "?";
+}
+
+// Resident and peak resident set size of this process, 0 if unknown
+void memoryUse(size_t& rss, size_t& peak) {
+    rss = peak = 0;
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        rss  = pmc.WorkingSetSize;
+        peak = pmc.PeakWorkingSetSize;
+    }
+#else
+    rusage ru{};
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+#if defined(__APPLE__)
+        peak = size_t(ru.ru_maxrss);          // bytes
+#else
+        peak = size_t(ru.ru_maxrss) * 1024u;  // KiB
+#endif
+    }
+    rss = peak;
+#if defined(__linux__)
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        unsigned long pages = 0, resident = 0;
+        if (std::fscanf(f, "%lu %lu", &pages, &resident) == 2)
+            rss = size_t(resident) * size_t(sysconf(_SC_PAGESIZE));
+        std::fclose(f);
+    }
+#endif
+#endif
+}
+
+template <class T, class Parse>
+std::vector<T> splitList(const char* s, Parse parse) {
+    std::vector<T> v;
+    std::string tok;
+    for (const char* p = s; ; ++p) {
+        if (*p == ',' || *p == '\0') {
+            if (!tok.empty()) v.push_back(parse(tok));
+            tok.clear();
+            if (*p == '\0') break;
+        } else {
+            tok += *p;
+        }
+    }
+    return v;
+}
+
+bool parseArgs(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto need = [&]() { if (!v) { std::fprintf(stderr, "missing value for %s\n", a); return false; } ++i; return true; };
+
+        if (!std::strcmp(a, "--n")) {
+            if (!need()) return false;
+            o.counts = splitList<size_t>(v, [](const std::string& t) { return size_t(std::stod(t)); });
+        } else if (!std::strcmp(a, "--solver")) {
+            if (!need()) return false;
+            o.solvers = splitList<Simulator::Solver>(v, [](const std::string& t) {
+                if (t == "bh" || t == "barnes-hut")    return Simulator::Solver::BarnesHut;
+                if (t == "pm" || t == "particle-mesh") return Simulator::Solver::ParticleMesh;
+                return Simulator::Solver::Naive;
+            });
+        } else if (!std::strcmp(a, "--threads")) {
+            if (!need()) return false;
+            o.threads = splitList<unsigned>(v, [](const std::string& t) { return unsigned(std::stoul(t)); });
+        } else if (!std::strcmp(a, "--min-time"))  { if (!need()) return false; o.minTime  = std::atof(v); }
+        else if (!std::strcmp(a, "--max-pairs"))   { if (!need()) return false; o.maxPairs = std::atof(v); }
+        else if (!std::strcmp(a, "--format"))      { if (!need()) return false; o.csv = !std::strcmp(v, "csv"); }
+        else if (!std::strcmp(a, "--out"))         { if (!need()) return false; o.out = v; }
+        else if (!std::strcmp(a, "--label"))       { if (!need()) return false; o.label = v; }
+        else if (!std::strcmp(a, "--broadphase"))  { o.broadPhase = true; }
+        else if (!std::strcmp(a, "--field"))       { o.field = true; }
+        else if (!std::strcmp(a, "--error"))       { o.error = true; }
+        else if (!std::strcmp(a, "--theta"))       { if (!need()) return false; o.theta = float(std::atof(v)); }
+        else {
+            std::fprintf(stderr, "unknown option %s\n", a);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Pair evaluations per step the solver actually performs (rough for Barnes–Hut)
+double pairWork(Simulator::Solver s, size_t n) {
+    const double N = double(n);
+    if (s == Simulator::Solver::Naive) return N * (N - 1.0) * 0.5;
+    if (s == Simulator::Solver::ParticleMesh) return N * 16.0; // deposit + gather; the grid cost is fixed
+    return N * 64.0 * std::max(1.0, std::log2(N)); // ~leaf + cell interactions per particle
+}
+
+// Seeded neutral gas filling the default 8 m x 6 m box
+void fillGas(Simulator& sim, size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    const auto& P = sim.params();
+    std::uniform_real_distribution<float> ux(0.f, P.boundsW), uy(0.f, P.boundsH), uv(-0.1f, 0.1f);
+    for (size_t i = 0; i < n; ++i) {
+        const float q = (i & 1) ? 1e-7f : -1e-7f;
+        sim.addParticle({ { ux(rng), uy(rng) }, { uv(rng), uv(rng) }, q, 1e-3f, 0.01f });
+    }
+}
+
+Result runCase(const Options& o, Simulator::Solver solver, unsigned threads, size_t n) {
+    Simulator::Params P;
+    P.softening2 = 0.05f * 0.05f;
+    P.maxAccel   = 1.0e4f;
+    P.solver     = solver;
+    P.threads    = threads;
+    P.theta      = o.theta;
+
+    Simulator sim(P);
+    sim.setBoundsEnabled(true);
+    fillGas(sim, n, 12345u);
+
+    const float dt = 1.0f / 240.0f;
+    sim.step(dt); // warm-up: pool start, tree buffers, page faults
+
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    double elapsed = 0.0;
+    int steps = 0;
+    while (steps < 3 || elapsed < o.minTime) {
+        sim.step(dt);
+        ++steps;
+        elapsed = std::chrono::duration<double>(clock::now() - t0).count();
+        if (steps >= 100000) break;
+    }
+
+    Result r{};
+    r.solver  = solverName(solver);
+    r.threads = ThreadPool::resolveThreads(threads);
+    r.n       = n;
+    r.steps   = steps;
+    r.seconds = elapsed;
+    r.stepsPerSec   = steps / elapsed;
+    const double pairs = double(n) * double(n - 1) * 0.5;
+    r.nsPerPair     = pairs > 0.0 ? elapsed * 1e9 / (steps * pairs) : 0.0;
+    r.nsPerParticle = elapsed * 1e9 / (double(steps) * double(n));
+    memoryUse(r.rssBytes, r.peakRssBytes);
+    if (o.error) {
+        const Simulator::ForceError err = sim.measureForceError();
+        r.errRms = err.rmsRel;
+        r.errMax = err.maxRel;
+    }
+    return r;
+}
+
+// Collision detection alone: free flight between calls, only findContacts timed
+Result runBroadPhase(const Options& o, unsigned threads, size_t n) {
+    Simulator::Params P;
+    P.threads = threads;
+    // Box grows with N so the density (and contacts per particle) match n = 10^4
+    const float scale = std::sqrt(float(n) / 1e4f);
+    P.boundsW *= scale;
+    P.boundsH *= scale;
+    Simulator sim(P);
+    sim.setBoundsEnabled(true);
+    sim.setElectrostaticsEnabled(false);
+    fillGas(sim, n, 12345u);
+
+    ThreadPool pool(ThreadPool::resolveThreads(threads));
+    CollisionSolver cs;
+    const float dt = 1.0f / 240.0f;
+    cs.findContacts(sim.store(), pool); // warm-up: first full sort, buffers
+
+    using clock = std::chrono::steady_clock;
+    double elapsed = 0.0;
+    int steps = 0;
+    while (steps < 3 || elapsed < o.minTime) {
+        sim.step(dt);
+        const auto t0 = clock::now();
+        cs.findContacts(sim.store(), pool);
+        elapsed += std::chrono::duration<double>(clock::now() - t0).count();
+        ++steps;
+        if (steps >= 100000) break;
+    }
+    std::fprintf(stderr, "broad-phase n=%-8zu %8.1f candidates/particle  %zu contacts\n",
+                 n, double(cs.stats().candidates) / double(n), cs.stats().contacts);
+
+    Result r{};
+    r.solver  = "broad-phase";
+    r.threads = pool.size();
+    r.n       = n;
+    r.steps   = steps;
+    r.seconds = elapsed;
+    r.stepsPerSec   = steps / elapsed;
+    const double pairs = double(n) * double(n - 1) * 0.5;
+    r.nsPerPair     = elapsed * 1e9 / (steps * pairs); // vs. an all-pairs test
+    r.nsPerParticle = elapsed * 1e9 / (double(steps) * double(n));
+    memoryUse(r.rssBytes, r.peakRssBytes);
+    return r;
+}
+
+// Field overlay alone: every call is a forced refresh of the whole grid
+Result runField(const Options& o, unsigned threads, size_t n) {
+    Simulator::Params P;
+    Simulator sim(P);
+    fillGas(sim, n, 12345u);
+
+    ThreadPool pool(ThreadPool::resolveThreads(threads));
+    FieldMap fm;
+    FieldMap::Config c;
+    c.cols = 100;
+    c.rows = 75;
+    c.boundsW = P.boundsW;
+    c.boundsH = P.boundsH;
+    const auto& S = sim.store();
+    fm.update(c, S.x.data(), S.y.data(), S.q.data(), n, pool); // warm-up
+
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    double elapsed = 0.0;
+    int steps = 0;
+    while (steps < 3 || elapsed < o.minTime) {
+        fm.update(c, S.x.data(), S.y.data(), S.q.data(), n, pool, true);
+        ++steps;
+        elapsed = std::chrono::duration<double>(clock::now() - t0).count();
+        if (steps >= 100000) break;
+    }
+
+    Result r{};
+    r.solver  = "field-map";
+    r.threads = pool.size();
+    r.n       = n;
+    r.steps   = steps;
+    r.seconds = elapsed;
+    r.stepsPerSec   = steps / elapsed;
+    r.nsPerPair     = elapsed * 1e9 / (double(steps) * double(n) * double(c.cols * c.rows));
+    r.nsPerParticle = elapsed * 1e9 / (double(steps) * double(n));
+    memoryUse(r.rssBytes, r.peakRssBytes);
+    return r;
+}
+
+void writeCsv(FILE* f, const Options& o, const std::vector<Result>& rs) {
+    std::fprintf(f, "label,isa,solver,threads,n,steps,seconds,steps_per_sec,ns_per_pair,ns_per_particle,rss_bytes,peak_rss_bytes,theta,err_rms,err_max\n");
+    for (const auto& r : rs) {
+        std::fprintf(f, "%s,%s,%s,%u,%zu,%d,%.6f,%.6g,%.6g,%.6g,%zu,%zu,%.3g,%.6g,%.6g\n",
+                     o.label.c_str(), kernels::isaName(kernels::detectIsa()), r.solver, r.threads, r.n,
+                     r.steps, r.seconds, r.stepsPerSec, r.nsPerPair, r.nsPerParticle,
+                     r.rssBytes, r.peakRssBytes, o.theta, r.errRms, r.errMax);
+    }
+}
+
+void writeJson(FILE* f, const Options& o, const std::vector<Result>& rs) {
+    std::fprintf(f, "{\n  \"label\": \"%s\",\n  \"isa\": \"%s\",\n  \"hardware_threads\": %u,\n  \"cases\": [\n",
+                 o.label.c_str(), kernels::isaName(kernels::detectIsa()), ThreadPool::resolveThreads(0));
+    for (size_t i = 0; i < rs.size(); ++i) {
+        const auto& r = rs[i];
+        std::fprintf(f,
+            "    {\"solver\": \"%s\", \"threads\": %u, \"n\": %zu, \"steps\": %d, \"seconds\": %.6f, "
+            "\"steps_per_sec\": %.6g, \"ns_per_pair\": %.6g, \"ns_per_particle\": %.6g, "
+            "\"rss_bytes\": %zu, \"peak_rss_bytes\": %zu, \"theta\": %.3g, \"err_rms\": %.6g, \"err_max\": %.6g}%s\n",
+            r.solver, r.threads, r.n, r.steps, r.seconds, r.stepsPerSec, r.nsPerPair,
+            r.nsPerParticle, r.rssBytes, r.peakRssBytes, o.theta, r.errRms, r.errMax,
+            (i + 1 < rs.size()) ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parseArgs(argc, argv, o)) return 2;
+
+    std::vector<Result> results;
+    if (o.broadPhase) {
+        for (unsigned th : o.threads) {
+            for (size_t n : o.counts) {
+                if (n < 2) continue;
+                results.push_back(runBroadPhase(o, th, n));
+                const auto& r = results.back();
+                std::fprintf(stderr, "%-10s threads=%-3u n=%-8zu %10.2f calls/s  %8.3f ns/particle\n",
+                             r.solver, r.threads, r.n, r.stepsPerSec, r.nsPerParticle);
+            }
+        }
+        o.solvers.clear();
+    }
+    if (o.field) {
+        for (unsigned th : o.threads) {
+            for (size_t n : o.counts) {
+                if (double(n) * 7500.0 > o.maxPairs) continue;
+                results.push_back(runField(o, th, n));
+                const auto& r = results.back();
+                std::fprintf(stderr, "%-10s threads=%-3u n=%-8zu %10.2f refreshes/s  %8.3f ns/pair\n",
+                             r.solver, r.threads, r.n, r.stepsPerSec, r.nsPerPair);
+            }
+        }
+        o.solvers.clear();
+    }
+    for (auto solver : o.solvers) {
+        for (unsigned th : o.threads) {
+            for (size_t n : o.counts) {
+                if (n < 2) continue;
+                if (pairWork(solver, n) > o.maxPairs) {
+                    std::fprintf(stderr, "skip %s n=%zu (over --max-pairs)\n", solverName(solver), n);
+                    continue;
+                }
+                results.push_back(runCase(o, solver, th, n));
+                const auto& r = results.back();
+                std::fprintf(stderr, "%-10s threads=%-3u n=%-8zu %10.2f steps/s  %8.3f ns/pair",
+                             r.solver, r.threads, r.n, r.stepsPerSec, r.nsPerPair);
+                if (r.errRms >= 0.0) std::fprintf(stderr, "  err rms %.3g max %.3g", r.errRms, r.errMax);
+                std::fputc('\n', stderr);
+            }
+        }
+    }
+
+    FILE* f = stdout;
+    if (!o.out.empty() && !(f = std::fopen(o.out.c_str(), "w"))) {
+        std::fprintf(stderr, "cannot open %s\n", o.out.c_str());
+        return 1;
+    }
+    if (o.csv) writeCsv(f, o, results);
+    else       writeJson(f, o, results);
+    if (f != stdout) std::fclose(f);
+    return 0;
+}
@@ -0,0 +1,193 @@
+// ElectroSim_ensemble — headless parameter sweep over many independent scenes.
+//
+//   ElectroSim_ensemble [--scene gas,lattice,sheets] [--n 1000] [--softening 0.05]
+//                       [--restitution 1] [--charge 1e-7] [--mass 1e-3] [--dt 0.0041667]
+//                       [--time 1] [--seeds 1] [--solver naive|bh|pm] [--collisions]
+//                       [--precision float|mixed|double]
+//                       [--threads 0] [--split-above 20000] [--batch 4096]
+//                       [--sample-every 0] [--final-dir dir] [--out summary.csv]
+//
+// Every comma list is a sweep axis; one run per combination. --softening is a
+// distance (m; Params::softening2 is its square), --time is simulated seconds
+// per run, --seeds only changes the gas scene. Runs go through Ensemble (work
+// stealing over batches of small runs, large runs split across all threads)
+// and the summary CSV (energy drift, momentum, wall time) goes to --out or stdout.
+#include "Ensemble.hpp"
+#include "Scenes.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class Scene { Gas, Lattice, Sheets };
+
+struct Options {
+    std::vector<Scene>  scenes      = { Scene::Gas };
+    std::vector<size_t> counts      = { 1000 };
+    std::vector<float>  softening   = { 0.05f };
+    std::vector<float>  restitution = { 1.0f };
+    std::vector<float>  charge      = { 1e-7f };
+    std::vector<float>  mass        = { 1e-3f };
+    std::vector<float>  dt          = { 1.0f / 240.0f };
+    std::vector<unsigned> seeds     = { 1 };
+    double time = 1.0; // s simulated per run
+    Simulator::Solver solver = Simulator::Solver::Naive;
+    Simulator::Precision precision = Simulator::Precision::Float;
+    bool collisions = false;
+    Ensemble::Options run;
+    std::string out;
+};
+
+const char* sceneName(Scene s) {
+    switch (s) {
+        case Scene::Gas:     return "gas";
+        case Scene::Lattice: return "lattice";
+        case Scene::Sheets:  return "sheets";
+    }
+    return "?";
+}
+
+template <class T, class Parse>
+std::vector<T> splitList(const char* s, Parse parse) {
+    std::vector<T> v;
+    std::string tok;
+    for (const char* p = s; ; ++p) {
+        if (*p == ',' || *p == '\0') {
+            if (!tok.empty()) v.push_back(parse(tok));
+            tok.clear();
+            if (*p == '\0') break;
+        } else {
+            tok += *p;
+        }
+    }
+    return v;
+}
+
+bool parseArgs(int argc, char** argv, Options& o) {
+    auto toFloat = [](const std::string& t) { return std::stof(t); };
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto need = [&]() { if (!v) { std::fprintf(stderr, "missing value for %s\n", a); return false; } ++i; return true; };
+
+        if (!std::strcmp(a, "--scene")) {
+            if (!need()) return false;
+            o.scenes = splitList<Scene>(v, [](const std::string& t) {
+                if (t == "lattice") return Scene::Lattice;
+                if (t == "sheets")  return Scene::Sheets;
+                return Scene::Gas;
+            });
+        }
+        else if (!std::strcmp(a, "--n"))           { if (!need()) return false; o.counts = splitList<size_t>(v, [](const std::string& t) { return size_t(std::stod(t)); }); }
+        else if (!std::strcmp(a, "--softening"))   { if (!need()) return false; o.softening   = splitList<float>(v, toFloat); }
+        else if (!std::strcmp(a, "--restitution")) { if (!need()) return false; o.restitution = splitList<float>(v, toFloat); }
+        else if (!std::strcmp(a, "--charge"))      { if (!need()) return false; o.charge      = splitList<float>(v, toFloat); }
+        else if (!std::strcmp(a, "--mass"))        { if (!need()) return false; o.mass        = splitList<float>(v, toFloat); }
+        else if (!std::strcmp(a, "--dt"))          { if (!need()) return false; o.dt          = splitList<float>(v, toFloat); }
+        else if (!std::strcmp(a, "--seeds"))       { if (!need()) return false; o.seeds = splitList<unsigned>(v, [](const std::string& t) { return unsigned(std::stoul(t)); }); }
+        else if (!std::strcmp(a, "--time"))        { if (!need()) return false; o.time = std::atof(v); }
+        else if (!std::strcmp(a, "--solver")) {
+            if (!need()) return false;
+            o.solver = !std::strcmp(v, "bh") ? Simulator::Solver::BarnesHut
+                     : !std::strcmp(v, "pm") ? Simulator::Solver::ParticleMesh
+                                             : Simulator::Solver::Naive;
+        }
+        else if (!std::strcmp(a, "--precision")) {
+            if (!need()) return false;
+            o.precision = !std::strcmp(v, "double") ? Simulator::Precision::Double
+                        : !std::strcmp(v, "mixed")  ? Simulator::Precision::Mixed
+                                                    : Simulator::Precision::Float;
+        }
+        else if (!std::strcmp(a, "--collisions"))   { o.collisions = true; }
+        else if (!std::strcmp(a, "--threads"))      { if (!need()) return false; o.run.threads = unsigned(std::atoi(v)); }
+        else if (!std::strcmp(a, "--split-above"))  { if (!need()) return false; o.run.splitAbove = size_t(std::stod(v)); }
+        else if (!std::strcmp(a, "--batch"))        { if (!need()) return false; o.run.batchParticles = size_t(std::stod(v)); }
+        else if (!std::strcmp(a, "--sample-every")) { if (!need()) return false; o.run.sampleEvery = std::atoi(v); }
+        else if (!std::strcmp(a, "--final-dir"))    { if (!need()) return false; o.run.finalDir = v; }
+        else if (!std::strcmp(a, "--out"))          { if (!need()) return false; o.out = v; }
+        else {
+            std::fprintf(stderr, "unknown option %s\n", a);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Particle> makeScene(Scene s, size_t n, const Simulator::Params& P, const scenes::Body& b, unsigned seed) {
+    const float w = P.boundsW, h = P.boundsH;
+    switch (s) {
+        case Scene::Lattice: {
+            // as square as the box allows
+            const size_t nx = std::max<size_t>(1, size_t(std::lround(std::sqrt(double(n) * w / h))));
+            const size_t ny = std::max<size_t>(1, (n + nx - 1) / nx);
+            return scenes::lattice(nx, ny, 0.1f * w, 0.1f * h, 0.8f * w, 0.8f * h, b);
+        }
+        case Scene::Sheets:
+            return scenes::dipoleSheets(std::max<size_t>(1, n / 2), 0.5f * w, 0.3f * w, 0.15f * h, 0.7f * h, b);
+        case Scene::Gas:
+        default:
+            return scenes::randomGas(n, w, h, 0.1f, b, seed);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parseArgs(argc, argv, o)) return 2;
+
+    Ensemble ens;
+    for (Scene sc : o.scenes)
+    for (size_t n : o.counts)
+    for (float soft : o.softening)
+    for (float e : o.restitution)
+    for (float q : o.charge)
+    for (float m : o.mass)
+    for (float dt : o.dt)
+    for (unsigned seed : o.seeds) {
+        if (sc != Scene::Gas && seed != o.seeds.front()) continue; // seeds only vary the gas
+        Ensemble::Run r;
+        r.params.softening2  = soft * soft;
+        r.params.restitution = e;
+        r.params.maxAccel    = 1.0e4f;
+        r.params.solver      = o.solver;
+        r.params.p3m         = true;
+        r.params.precision   = o.precision;
+        r.dt         = dt;
+        r.steps      = std::max(1, int(std::lround(o.time / dt)));
+        r.collisions = o.collisions;
+
+        scenes::Body b;
+        b.charge = q;
+        b.mass   = m;
+        r.particles = makeScene(sc, n, r.params, b, seed);
+
+        char name[160];
+        std::snprintf(name, sizeof(name), "%s_n%zu_s%g_e%g_q%g_m%g_dt%g_seed%u",
+                      sceneName(sc), r.particles.size(), soft, e, q, m, dt, seed);
+        r.name = name;
+        ens.add(std::move(r));
+    }
+
+    std::fprintf(stderr, "%zu runs on %u threads\n", ens.size(), ThreadPool::resolveThreads(o.run.threads));
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto summaries = ens.run(o.run);
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    double busy = 0.0;
+    for (const auto& s : summaries) busy += s.wallSeconds;
+    std::fprintf(stderr, "done in %.2f s wall, %.2f s of stepping (%.2fx)\n", wall, busy, wall > 0.0 ? busy / wall : 0.0);
+
+    if (!Ensemble::writeCsv(o.out, summaries)) {
+        std::fprintf(stderr, "cannot write %s\n", o.out.c_str());
+        return 1;
+    }
+    return 0;
+}
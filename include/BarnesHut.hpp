@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+// Barnes–Hut quadtree over point charges (SI units), Morton-sorted; nodes keep
+// charge plus dipole about the |q|-weighted centre for near-neutral cells.
+class BarnesHutTree {
+public:
+    // Rebuild over n charges (SoA). The root square covers the world
+    // rectangle [0,boundsW] x [0,boundsH] plus any particle that left it.
+    void build(const float* x, const float* y, const float* q, size_t n,
+               float boundsW, float boundsH);
+
+    // Softened field sum at particle `self` (excluded):  sum_j q_j r_ij / R^3
+    // with R^2 = |r_ij|^2 + soft2. Multiply by k*q_i/m_i to get acceleration.
+    // Nodes are accepted when size/distance < theta.
+    sf::Vector2f field(size_t self, float theta, float soft2) const;
+    // Same walk, also giving the potential sum  phi = sum_j q_j / R  (the
+    // cell multipoles contribute q/R + p.r/R^3). Multiply by k for volts.
+    sf::Vector2f field(size_t self, float theta, float soft2, float& phi) const;
+
+    // Particle index at a Morton-sorted slot. Visiting particles in slot order
+    // keeps consecutive traversals on the same nodes (much better cache use).
+    uint32_t particleAt(size_t slot) const { return order_[slot]; }
+
+    size_t nodeCount() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        float size;              // side of the square cell (m)
+        float cx, cy;            // |q|-weighted centre (m)
+        float aq;                // sum of |q| (C); 0 means nothing to attract
+        float q;                 // total charge (C)
+        float dx, dy;            // dipole moment about (cx,cy) (C·m)
+        uint32_t begin, end;     // range in the sorted arrays
+        int32_t  child;          // first child index, -1 for a leaf
+        uint32_t nChild;         // children are contiguous
+    };
+
+    static constexpr uint32_t kLeafSize = 8;
+    static constexpr int      kMaxDepth = 16; // Morton codes carry 16 bits per axis
+
+    template <bool Pot>
+    sf::Vector2f walk(size_t self, float theta, float soft2, float& phi) const;
+
+    // Fill nodes_[id] (already allocated) for the sorted range [begin, end)
+    void buildNode(uint32_t id, uint32_t begin, uint32_t end, int depth,
+                   float minX, float minY, float size);
+
+    // All buffers keep their capacity across builds, so a steady-state
+    // rebuild does not allocate.
+    std::vector<Node>     nodes_;
+    std::vector<uint64_t> keys_;   // (code << 32) | index, sorted
+    std::vector<uint32_t> code_;   // Morton code per sorted slot
+    std::vector<uint32_t> order_;  // sorted slot -> particle index
+    std::vector<uint32_t> slot_;   // particle index -> sorted slot
+    std::vector<float>    x_, y_, q_; // sorted copies
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ParticleStore.hpp"
+
+class ThreadPool;
+
+// Contacts: spatial hash kept sorted across steps (only movers re-sorted), circle
+// narrow phase, impulse resolution. No wrap across periodic walls.
+class CollisionSolver {
+public:
+    struct Contact { uint32_t i, j; }; // i < j
+
+    struct Stats {
+        size_t candidates = 0; // same-cell pairs tested by the narrow phase
+        size_t contacts = 0;   // overlapping pairs
+        size_t moved = 0;      // particles re-sorted because they changed bucket
+        bool   fullRebuild = false; // the sort was rebuilt from scratch
+    };
+
+    // Broad + narrow phase. Fills contacts() with overlapping pairs, sorted by (i, j).
+    void findContacts(const ParticleStore& s, ThreadPool& pool);
+
+    // Separate overlaps and apply -(1 + e) v_n / (1/m_i + 1/m_j); serial, thread-count independent
+    void resolve(ParticleStore& s, float restitution) const;
+
+    const std::vector<Contact>& contacts() const { return contacts_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    void sortByBucket(const ParticleStore& s);
+    uint32_t bucketOf(int32_t cx, int32_t cy) const;
+
+    float cell_ = 0.f;     // m
+    float invCell_ = 0.f;
+    uint32_t mask_ = 0;    // bucket table size - 1
+
+    // Sorted by bucket; slot -> particle, bucket and integer cell
+    std::vector<uint32_t> order_, key_;
+    std::vector<int32_t>  cellX_, cellY_;
+    std::vector<uint32_t> bucketStart_;  // mask_ + 2 entries
+
+    struct Moved { uint32_t key, p; int32_t cx, cy; };
+    std::vector<Moved>    moved_;        // incremental re-sort scratch
+    std::vector<uint32_t> tmp_;          // counting-sort scratch
+    std::vector<std::vector<Contact>> perWorker_;
+    std::vector<size_t> candidates_;     // per worker
+    std::vector<Contact> contacts_;
+    Stats stats_;
+};
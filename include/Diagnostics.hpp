@@ -0,0 +1,49 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Conserved quantities of one step (SI units), produced by Simulator inside
+// its force and integration passes rather than by an extra O(N^2) sweep.
+struct StepDiagnostics {
+    uint64_t step = 0;         // steps since diagnostics were switched on / cleared
+    double time = 0.0;         // s, same origin; the step's force time (block steps: its end)
+    double kinetic = 0.0;      // J
+    double potential = 0.0;    // J, softened pair sum 0.5 k sum_i q_i phi_i (box only)
+    double px = 0.0, py = 0.0; // total momentum (kg m/s)
+    uint32_t clampHits = 0;    // particles whose acceleration hit maxAccel
+    bool hasPotential = false; // false when the solver cannot give phi (mesh, block steps)
+
+    double total() const { return kinetic + (hasPotential ? potential : 0.0); }
+    double momentum() const { return std::sqrt(px * px + py * py); }
+};
+
+// Fixed-capacity ring of the most recent steps; pushing never allocates once
+// constructed. Index 0 is the oldest entry still held.
+class DiagnosticsSeries {
+public:
+    explicit DiagnosticsSeries(size_t capacity = 4096) : buf_(capacity ? capacity : 1) {}
+
+    void push(const StepDiagnostics& d) {
+        buf_[head_] = d;
+        head_ = (head_ + 1) % buf_.size();
+        if (count_ < buf_.size()) ++count_;
+    }
+    void clear() { head_ = count_ = 0; }
+
+    size_t size() const     { return count_; }
+    size_t capacity() const { return buf_.size(); }
+    bool empty() const      { return count_ == 0; }
+
+    const StepDiagnostics& operator[](size_t i) const {
+        return buf_[(head_ + buf_.size() - count_ + i) % buf_.size()];
+    }
+    const StepDiagnostics& front() const { return (*this)[0]; }
+    const StepDiagnostics& back() const  { return (*this)[count_ - 1]; }
+
+private:
+    std::vector<StepDiagnostics> buf_;
+    size_t head_ = 0;  // next slot to write
+    size_t count_ = 0;
+};
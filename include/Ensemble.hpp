@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Particle.hpp"
+#include "Simulator.hpp"
+
+// Independent Simulators for parameter sweeps: runs above splitAbove get all
+// threads one at a time, the rest are batched single-threaded with work stealing.
+class Ensemble {
+public:
+    struct Run {
+        std::string name;
+        Simulator::Params params;          // threads is chosen by the scheduler
+        std::vector<Particle> particles;
+        float dt = 1.0f / 240.0f;          // s
+        int steps = 240;
+        bool electrostatics = true, bounds = true, collisions = false;
+    };
+
+    struct Options {
+        unsigned threads = 0;         // 0 = all hardware threads
+        size_t splitAbove = 20000;    // particles; bigger runs get the whole machine
+        size_t batchParticles = 4096; // small runs are grouped up to this many particles
+        int sliceSteps = 32;          // steps per scheduling slice
+        int sampleEvery = 0;          // steps between extra energy samples (0 = start and end only)
+        std::string finalDir;         // if set, each run's final state goes to <finalDir>/<name>.esck
+    };
+
+    // Observables of one finished run (SI units); energy is KE plus the softened
+    // pair potential in double, from the per-step diagnostics for split runs.
+    struct Summary {
+        std::string name;
+        size_t n = 0;
+        int steps = 0;
+        double simTime = 0.0;      // s
+        double wallSeconds = 0.0;  // time spent stepping this run
+        double e0 = 0.0, e1 = 0.0; // J, start and end
+        double drift = 0.0;        // (e1 - e0) / |e0|
+        double maxDrift = 0.0;     // worst |e - e0| / |e0| over the samples
+        double px0 = 0.0, py0 = 0.0, px1 = 0.0, py1 = 0.0; // total momentum (kg m/s)
+        bool split = false;        // ran alone on all threads
+        bool savedFinal = false;
+    };
+
+    void add(Run r) { runs_.push_back(std::move(r)); }
+    size_t size() const { return runs_.size(); }
+
+    // Runs everything once; summaries come back in add() order
+    std::vector<Summary> run(const Options& o);
+
+    // One header line, then one line per summary
+    static bool writeCsv(const std::string& path, const std::vector<Summary>& s);
+
+private:
+    std::vector<Run> runs_;
+};
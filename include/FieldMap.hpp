@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ForceKernels.hpp"
+#include "ThreadPool.hpp"
+
+// Softened potential and E of a set of charges at the cell centres of a
+// cols x rows grid over [0, boundsW] x [0, boundsH] (box only, like Naive).
+class FieldMap {
+public:
+    struct Config {
+        unsigned cols = 160, rows = 120;   // samples per axis
+        float boundsW = 8.0f, boundsH = 6.0f; // m
+        float k = 8.9875517923e9f;         // N·m^2/C^2
+        float softening2 = 1e-4f;          // m^2
+        float moveTolerance = 0.01f;       // m; larger moves (or any charge change) trigger a refresh
+        unsigned minInterval = 1;          // update() calls between refreshes (1 = every call)
+        kernels::Isa isa = kernels::Isa::Auto;
+    };
+
+    FieldMap() = default;
+    FieldMap(const FieldMap&) = delete;
+    FieldMap& operator=(const FieldMap&) = delete;
+
+    // True if recomputed: when forced, on a config change, or after a move past tolerance
+    bool update(const Config& c, const float* x, const float* y, const float* q, size_t n,
+                ThreadPool& pool, bool force = false);
+
+    unsigned cols() const { return cfg_.cols; }
+    unsigned rows() const { return cfg_.rows; }
+
+    // Row-major samples, index r * cols + c (sample at ((c + 0.5) W/cols, (r + 0.5) H/rows))
+    const std::vector<float>& potential() const { return phi_; } // V
+    const std::vector<float>& ex() const { return ex_; }         // V/m
+    const std::vector<float>& ey() const { return ey_; }         // V/m
+
+    uint64_t refreshes() const { return refreshes_; }
+
+private:
+    bool sameGrid(const Config& c) const;
+    bool moved(const float* x, const float* y, const float* q, size_t n, float tol) const;
+    void compute(const float* x, const float* y, const float* q, size_t n, ThreadPool& pool);
+
+    Config cfg_;
+    bool valid_ = false;
+    unsigned age_ = 0;        // update() calls since the last refresh
+    uint64_t refreshes_ = 0;
+
+    std::vector<float> px_, py_;               // sample positions (m)
+    std::vector<float> refX_, refY_, refQ_;    // charges at the last refresh
+    std::vector<float> phi_, ex_, ey_;
+};
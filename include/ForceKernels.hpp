@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+
+// Pairwise Coulomb kernels over SoA arrays; scalar, SSE and AVX2 use the same
+// IEEE ops and lane order, so they are bit-identical.
+namespace kernels {
+
+enum class Isa {
+    Auto,   // best supported by this CPU
+    Scalar,
+    SSE,    // SSE2, 2x4 lanes
+    AVX2    // 8 lanes
+};
+
+// Best ISA this CPU supports (cached after the first call)
+Isa detectIsa();
+
+// Resolve Auto / unsupported requests to something this CPU can run
+Isa resolveIsa(Isa requested);
+
+const char* isaName(Isa isa);
+
+// For target rows i in [begin, end):
+//   ax[i], ay[i] = k * q[i] * invMass[i] * sum_j q[j] (r_i - r_j) / R^3,
+//   R^2 = |r_i - r_j|^2 + soft2.
+// Pairs at zero separation (including i == j) contribute nothing.
+// phi, if given, gets sum_j q[j] / R (unscaled); ax/ay are unchanged bit for bit.
+void coulombRows(Isa isa,
+                 const float* x, const float* y, const float* q, const float* invMass,
+                 size_t n, float k, float soft2,
+                 size_t begin, size_t end,
+                 float* ax, float* ay, float* phi = nullptr);
+
+// Symmetric pair sum between blocks [i0, i1) and [j0, j1), each pair visited
+// once (j > i when i0 == j0, i.e. the blocks coincide):
+//   ex[i] += q[j] r_ij / R^3,   ex[j] -= q[i] r_ij / R^3
+// (and phi likewise). Scale by k*q*invMass afterwards; half the pairs of
+// coulombRows, equal only to rounding. AVX2 or scalar.
+void coulombPairTile(Isa isa,
+                     const float* x, const float* y, const float* q, float soft2,
+                     size_t i0, size_t i1, size_t j0, size_t j1,
+                     float* ex, float* ey, float* phi = nullptr);
+
+// coulombRows for Precision::Mixed: the same float pair terms, each widened
+// to double before it is summed (double lanes, reduction and outputs).
+// AVX2 or scalar, bit-identical (an SSE request runs the scalar body).
+void coulombRowsMixed(Isa isa,
+                      const float* x, const float* y, const float* q, const float* invMass,
+                      size_t n, float k, float soft2,
+                      size_t begin, size_t end,
+                      double* ax, double* ay, double* phi = nullptr);
+
+// Adds phi = sum_j q[j] / R and E = sum_j q[j] (p_s - r_j) / R^3 from sources
+// [j0, j1) at m points (px, py); scale by k afterwards. AVX2 or scalar.
+void fieldAtPoints(Isa isa,
+                   const float* x, const float* y, const float* q, size_t j0, size_t j1, float soft2,
+                   const float* px, const float* py, size_t m,
+                   float* phi, float* ex, float* ey);
+
+} // namespace kernels
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory map of a whole file (POSIX mmap / Win32 file mapping).
+// Pages are faulted in on first touch, so opening is O(1) in the file size.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile(); // close()
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path); // false if missing, unreadable or empty
+    void close();
+
+    bool isOpen() const          { return data_ != nullptr; }
+    const uint8_t* data() const  { return data_; }
+    size_t size() const          { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
@@ -1,5 +1,12 @@
 #pragma once
-#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+
+// Render colour carried with a particle. Plain RGBA8 rather than sf::Color so
+// the physics library does not link sfml-graphics; main.cpp converts.
+struct Rgba8 {
+    std::uint8_t r = 255, g = 255, b = 255, a = 255;
+};
 
 struct Particle {
     sf::Vector2f pos;
@@ -9,5 +16,5 @@ struct Particle {
     float mass;
     float radius;
 
-    sf::Color color = sf::Color::White;
+    Rgba8 color{};
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ParticleStore.hpp"
+
+class ThreadPool;
+
+// PM / P3M Coulomb solver: CIC deposit, FFT convolution with the softened 1/R
+// kernel, central-difference E; P3M adds the exact erfc near field within 3s.
+class ParticleMesh {
+public:
+    struct Config {
+        unsigned grid = 128;      // nodes per axis, power of two
+        float boundsW = 8.0f;     // m
+        float boundsH = 6.0f;     // m
+        float soft2 = 1e-4f;      // m^2
+        bool  periodic = false;
+        bool  p3m = false;
+        float split = 2.0f;       // P3M splitting length s, in mesh cells
+    };
+
+    // Unclamped accelerations (m/s^2); outside charges sit on the edge (or wrap if periodic)
+    void compute(const ParticleStore& s, float k, const Config& c, ThreadPool& pool,
+                 float* ax, float* ay);
+
+private:
+    using cfloat = std::complex<float>;
+
+    // Radix-2 complex FFT of one fixed length
+    struct FFT {
+        size_t n = 0;
+        std::vector<cfloat>   tw;   // e^{-2 pi i k / n}, k < n/2
+        std::vector<uint32_t> rev;  // bit reversal
+        void init(size_t len);
+        void run(cfloat* a, bool inverse) const;
+    };
+
+    void configure(const Config& c, ThreadPool& pool);
+    void fft2d(std::vector<cfloat>& a, bool inverse, size_t rowsUsed, ThreadPool& pool);
+    void shortRange(const ParticleStore& s, float k, ThreadPool& pool, float* ax, float* ay);
+
+    // Kernel/grid state; rebuilt only when the Config changes
+    Config cfg_{};
+    bool configured_ = false;
+    size_t n_ = 0;            // nodes per axis
+    size_t Lx_ = 0, Ly_ = 0;  // FFT size (n, or 2n zero-padded)
+    float hx_ = 0.f, hy_ = 0.f;
+    float sigma_ = 0.f;       // P3M split length (m)
+    FFT fftX_, fftY_;
+    std::vector<float> kernelHat_; // real (kernel is even), 1/(Lx*Ly) folded in
+
+    // Per-step scratch
+    std::vector<cfloat> rho_;       // charge -> potential, in place
+    std::vector<float>  ex_, ey_;   // field on the n x n nodes
+    std::vector<std::vector<cfloat>> colScratch_; // one column buffer per worker
+
+    // P3M cell list
+    std::vector<uint32_t> cellStart_, cellItems_, cellOf_;
+    size_t cx_ = 0, cy_ = 0;
+    float cellW_ = 0.f, cellH_ = 0.f;
+};
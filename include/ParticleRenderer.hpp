@@ -0,0 +1,35 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "ParticleStore.hpp"
+
+// Draws every particle in at most two draw calls: textured quads, or single
+// pixels below one pixel across. Buffers keep their capacity between frames.
+class ParticleRenderer {
+public:
+    // Smallest radius drawn for a visible disc, in pixels (keeps tiny charges clickable/visible)
+    float minRadiusPx = 2.0f;
+
+    // Raw SoA input so the same path serves the live store, snapshots and replays
+    void draw(sf::RenderTarget& target,
+              const float* x, const float* y, const float* radius, const Rgba8* color,
+              size_t n, float ppm);
+
+    void draw(sf::RenderTarget& target, const ParticleStore& s, float ppm) {
+        draw(target, s.x.data(), s.y.data(), s.radius.data(), s.color.data(), s.size(), ppm);
+    }
+
+    // Counts from the last draw()
+    size_t discCount() const  { return discs_.size() / 6; }
+    size_t pointCount() const { return points_.size(); }
+
+private:
+    static constexpr unsigned kDiscTexSize = 64;
+
+    void ensureTexture();
+
+    sf::Texture disc_;
+    bool discReady_ = false;
+    std::vector<sf::Vertex> discs_;  // sf::Triangles, 6 per particle
+    std::vector<sf::Vertex> points_; // sf::Points, 1 per particle
+};
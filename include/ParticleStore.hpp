@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "Particle.hpp"
+
+// Structure-of-arrays particle storage (SI units); colour is render-only.
+struct ParticleStore {
+    // hot
+    std::vector<float> x, y;     // position (m)
+    std::vector<float> vx, vy;   // velocity (m/s)
+    std::vector<float> q;        // charge (C)
+    std::vector<float> invMass;  // 1/kg
+    // cold
+    std::vector<float> mass;     // kg
+    std::vector<float> radius;   // m
+    std::vector<Rgba8> color;    // render only
+
+    size_t size() const { return x.size(); }
+    bool empty() const  { return x.empty(); }
+
+    void clear() {
+        x.clear(); y.clear(); vx.clear(); vy.clear();
+        q.clear(); invMass.clear(); mass.clear(); radius.clear(); color.clear();
+    }
+
+    void reserve(size_t n) {
+        x.reserve(n); y.reserve(n); vx.reserve(n); vy.reserve(n);
+        q.reserve(n); invMass.reserve(n); mass.reserve(n); radius.reserve(n); color.reserve(n);
+    }
+
+    void push(const Particle& p) {
+        x.push_back(p.pos.x);  y.push_back(p.pos.y);
+        vx.push_back(p.vel.x); vy.push_back(p.vel.y);
+        q.push_back(p.charge);
+        invMass.push_back(1.0f / p.mass);
+        mass.push_back(p.mass);
+        radius.push_back(p.radius);
+        color.push_back(p.color);
+    }
+
+    // Bulk append: reserve (geometrically) once, then straight column fills
+    void append(const Particle* ps, size_t n) {
+        const size_t at = size();
+        if (at + n > x.capacity()) reserve(std::max(at + n, 2 * x.capacity()));
+        x.resize(at + n); y.resize(at + n); vx.resize(at + n); vy.resize(at + n);
+        q.resize(at + n); invMass.resize(at + n); mass.resize(at + n); radius.resize(at + n); color.resize(at + n);
+        for (size_t i = 0; i < n; ++i) {
+            const Particle& p = ps[i];
+            x[at + i] = p.pos.x;  y[at + i] = p.pos.y;
+            vx[at + i] = p.vel.x; vy[at + i] = p.vel.y;
+            q[at + i] = p.charge;
+            invMass[at + i] = 1.0f / p.mass;
+            mass[at + i] = p.mass;
+            radius[at + i] = p.radius;
+            color[at + i] = p.color;
+        }
+    }
+
+    Particle get(size_t i) const {
+        return { {x[i], y[i]}, {vx[i], vy[i]}, q[i], mass[i], radius[i], color[i] };
+    }
+
+    void set(size_t i, const Particle& p) {
+        x[i] = p.pos.x;  y[i] = p.pos.y;
+        vx[i] = p.vel.x; vy[i] = p.vel.y;
+        q[i] = p.charge;
+        invMass[i] = 1.0f / p.mass;
+        mass[i] = p.mass;
+        radius[i] = p.radius;
+        color[i] = p.color;
+    }
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Simulator.hpp"
+#include "Trajectory.hpp"
+#include "TripleBuffer.hpp"
+
+// What the render loop needs from one physics state (SoA, SI units)
+struct Snapshot {
+    std::vector<float> x, y, radius, q;
+    std::vector<Rgba8> color;
+    uint64_t steps = 0;    // steps taken when captured
+    double simTime = 0.0;  // s
+    StepDiagnostics diag;  // last step's, when the Simulator has diagnostics on
+    float k = 0.f, softening2 = 0.f; // Params the field overlay needs
+    float boundsW = 0.f, boundsH = 0.f, bz = 0.f; // and the view and Bz row (checkpoint loads change them)
+
+    size_t size() const { return x.size(); }
+    void capture(const ParticleStore& s, uint64_t steps, double simTime);
+};
+
+// Steps a Simulator at a fixed dt on its own thread; the render thread reads
+// lock-free Snapshots and sends edits as commands.
+class PhysicsThread {
+public:
+    using Command = std::function<void(Simulator&)>;
+
+    PhysicsThread(Simulator& sim, float dt);
+    ~PhysicsThread(); // stops and joins
+
+    PhysicsThread(const PhysicsThread&) = delete;
+    PhysicsThread& operator=(const PhysicsThread&) = delete;
+
+    void start();
+    void stop();
+
+    // Render -> physics. Runs on the physics thread before the next batch.
+    void post(Command cmd);
+
+    // Step through `w` (recording as it goes) instead of calling advance()
+    // directly. Set before start(); the writer then belongs to the physics
+    // thread until stop().
+    void setRecorder(TrajectoryWriter* w) { recorder_ = w; }
+
+    // While paused no time accumulates (same rule as the old frame loop)
+    void setPaused(bool p);
+    bool paused() const { return paused_.load(std::memory_order_relaxed); }
+
+    // Newest published state; valid until the next call. Render thread only.
+    const Snapshot& latest(bool* updated = nullptr) { return snapshots_.read(updated); }
+
+    // Measured over the last second of wall time
+    float stepsPerSecond() const { return stepsPerSec_.load(std::memory_order_relaxed); }
+    // Sim time thrown away because a batch hit maxStepsPerBatch (s, cumulative)
+    double droppedTime() const  { return dropped_.load(std::memory_order_relaxed); }
+
+    // Spiral-of-death guard, as in the old frame loop
+    int   maxStepsPerBatch = 240;
+    float maxCatchUp = 0.25f; // s of wall time accounted per wake-up
+
+private:
+    void run();
+    void drainCommands();
+    void publish();
+
+    Simulator& sim_;
+    const float dt_;
+    TrajectoryWriter* recorder_ = nullptr;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> paused_{true};
+
+    std::mutex m_;                 // guards pending_ and paused_ writes; wakes the thread early
+    std::condition_variable cv_;
+    std::vector<Command> pending_;
+    std::vector<Command> work_;    // physics-thread copy, swapped with pending_
+
+    TripleBuffer<Snapshot> snapshots_;
+    uint64_t steps_ = 0;
+    double simTime_ = 0.0;
+
+    std::atomic<float>  stepsPerSec_{0.f};
+    std::atomic<double> dropped_{0.0};
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <type_traits>
+
+// Scalar policies: `real` for state and pair terms, `accum` for force and energy sums.
+namespace precision {
+
+template <class Real, class Accum>
+struct Policy {
+    using real  = Real;
+    using accum = Accum;
+    static_assert(std::is_floating_point_v<Real> && std::is_floating_point_v<Accum>);
+    static_assert(sizeof(Accum) >= sizeof(Real), "accumulate in at least the pair precision");
+
+    // State lives in its own double columns, mirrored into the float store
+    static constexpr bool kOwnState = !std::is_same_v<Real, float>;
+};
+
+using Float  = Policy<float,  float>;
+using Mixed  = Policy<float,  double>;
+using Double = Policy<double, double>;
+
+} // namespace precision
@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+// Per-phase wall-clock ring buffers; compiled out without ELECTROSIM_PROFILE.
+// One writer thread per phase, any reader.
+namespace prof {
+
+#if defined(ELECTROSIM_PROFILE)
+inline constexpr bool kEnabled = true;
+#else
+inline constexpr bool kEnabled = false;
+#endif
+
+enum class Phase : uint8_t {
+    // Simulator::advance (physics thread)
+    Forces,     // force solver + clamp
+    Integrate,  // velocity/position update (kicks and drifts in block mode)
+    Contacts,   // collision detection and resolution
+    Bounds,     // walls
+    // main.cpp frame (render thread)
+    Events,     // window events
+    Update,     // physics batch in --sync mode
+    Field,      // field overlay refresh
+    Draw,       // particles, overlay and UI
+    Display,    // buffer swap (includes the frame limiter's sleep)
+    Frame,      // whole frame
+    Count
+};
+
+enum class Counter : uint8_t {
+    StepsPerFrame, // physics steps since the previous frame
+    DroppedTime,   // sim time dropped at the step cap (s, cumulative)
+    Particles,
+    Count
+};
+
+const char* phaseName(Phase p);
+const char* counterName(Counter c);
+
+// ns on the steady clock
+inline uint64_t now() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Small dense id per thread that records (trace "tid")
+uint32_t threadIndex();
+
+class Profiler {
+public:
+    static constexpr size_t kRing = 1024; // spans kept per phase / values per counter
+
+    struct Stats {
+        double minMs = 0.0, meanMs = 0.0, p99Ms = 0.0;
+        size_t samples = 0; // spans in the window (<= kRing)
+    };
+
+    Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    void record(Phase p, uint64_t t0, uint64_t t1) {
+        if constexpr (kEnabled) push(tracks_[size_t(p)], t0, t1 - t0);
+    }
+    void count(Counter c, double value) {
+        if constexpr (kEnabled) {
+            uint64_t bits;
+            static_assert(sizeof(bits) == sizeof(value));
+            std::memcpy(&bits, &value, sizeof(bits));
+            push(tracks_[size_t(Phase::Count) + size_t(c)], now(), bits);
+        }
+    }
+
+    // Over the spans currently in the ring
+    Stats stats(Phase p) const;
+    double latest(Counter c) const;
+
+    // kind,name,thread,start_us,value per span / counter value (us since construction)
+    bool writeCsv(const std::string& path) const;
+    // Chrome trace JSON: complete events ("X") per span, counter events ("C")
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    static constexpr size_t kTracks = size_t(Phase::Count) + size_t(Counter::Count);
+
+    // Single writer; readers take what is below head
+    struct Slot {
+        std::atomic<uint64_t> t{0}, v{0};
+        std::atomic<uint32_t> tid{0};
+    };
+    struct Ring {
+        std::array<Slot, kRing> slot;
+        std::atomic<uint64_t> head{0}; // spans ever pushed
+    };
+
+    void push(Ring& r, uint64_t t, uint64_t v) {
+        const uint64_t h = r.head.load(std::memory_order_relaxed);
+        Slot& s = r.slot[h % kRing];
+        s.t.store(t, std::memory_order_relaxed);
+        s.v.store(v, std::memory_order_relaxed);
+        s.tid.store(threadIndex(), std::memory_order_relaxed);
+        r.head.store(h + 1, std::memory_order_release);
+    }
+
+    template <class F> void forEach(size_t track, F&& fn) const; // oldest first
+
+    std::unique_ptr<Ring[]> tracks_;
+    uint64_t epoch_; // ns
+};
+
+// Times its enclosing block into p (nothing if p is null or profiling is off)
+class Scope {
+public:
+    Scope(Profiler* p, Phase ph) {
+        if constexpr (kEnabled) {
+            if (p) { p_ = p; ph_ = ph; t0_ = now(); }
+        }
+    }
+    ~Scope() { stop(); }
+
+    // End the span early (the destructor then records nothing)
+    void stop() {
+        if constexpr (kEnabled) {
+            if (p_) p_->record(ph_, t0_, now());
+            p_ = nullptr;
+        }
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    Profiler* p_ = nullptr;
+    Phase ph_ = Phase::Frame;
+    uint64_t t0_ = 0;
+};
+
+} // namespace prof
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Particle.hpp"
+
+// Procedural scenes (SI units) in one block for Simulator::addParticles;
+// positive charges red, negative blue.
+namespace scenes {
+
+// Per-particle properties shared by every generator
+struct Body {
+    float charge = 1e-7f;   // C, magnitude
+    float mass   = 1e-3f;   // kg
+    float radius = 0.01f;   // m
+};
+
+// nx * ny sites evenly filling [x0, x0 + w] x [y0, y0 + h], at rest.
+// alternate: checkerboard signs (neutral ionic crystal); otherwise all +q.
+std::vector<Particle> lattice(size_t nx, size_t ny, float x0, float y0, float w, float h,
+                              const Body& b = {}, bool alternate = true);
+
+// n particles uniformly in [0, w] x [0, h] with velocity components uniform in
+// [-speed, speed] m/s. Signs alternate, so even n is exactly neutral.
+std::vector<Particle> randomGas(size_t n, float w, float h, float speed,
+                                const Body& b = {}, uint32_t seed = 12345u);
+
+// Two parallel vertical sheets of `perSheet` charges spanning [y0, y0 + h]:
+// +q at x = cx - gap/2, -q at x = cx + gap/2 (a parallel-plate capacitor).
+std::vector<Particle> dipoleSheets(size_t perSheet, float cx, float gap, float y0, float h,
+                                   const Body& b = {});
+
+} // namespace scenes
@@ -1,6 +1,19 @@
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
 #include <vector>
 #include "Particle.hpp"
+#include "ParticleStore.hpp"
+#include "ForceKernels.hpp"
+#include "BarnesHut.hpp"
+#include "Collisions.hpp"
+#include "Diagnostics.hpp"
+#include "ParticleMesh.hpp"
+#include "Precision.hpp"
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
 
 // Forward-declare to keep header light.
 namespace sf {
@@ -10,6 +23,35 @@ namespace sf {
 
 class Simulator {
 public:
+    // Force solver used by step()
+    enum class Solver {
+        Naive,        // exact pairwise sum, O(N^2)
+        BarnesHut,    // quadtree multipole approximation, O(N log N)
+        ParticleMesh  // FFT grid (PM, or P3M with exact near field), O(N + G log G)
+    };
+
+    // What the walls do when bounds are enabled
+    enum class Boundary {
+        Reflect,  // bouncy walls (restitution)
+        Periodic  // wrap around; only the ParticleMesh solver sees the images
+    };
+
+    // How step()/advance() move particles
+    enum class Integrator {
+        SymplecticEuler, // one shared dt
+        BlockTimestep,   // per-particle power-of-two fractions of dt
+        Boris            // shared dt, E kicks around an exact rotation in Bz
+    };
+
+    // Scalar policy for state and force sums (see Precision.hpp)
+    enum class Precision {
+        Float, // float everywhere, SIMD kernels (realtime)
+        Mixed, // float state and pair terms, double row sums
+        Double // double positions, velocities and pair terms
+    };
+
+    static constexpr unsigned kMaxBlockLevel = 16;
+
     // --------- Parameters (SI units) ----------
     struct Params {
         // Coulomb constant (N·m^2/C^2)
@@ -22,11 +64,79 @@ public:
         float boundsW = 8.0f;     // 8 m
         float boundsH = 6.0f;     // 6 m
 
-        // Wall reflection coefficient (unitless). 1.0 = perfect reflection.
+        // Wall and particle-particle restitution (unitless). 1.0 = perfectly elastic.
         float restitution = 1.0f;
 
         // Safety clamp for acceleration magnitude (m/s^2)
         float maxAccel = 1.0e2f;
+
+        // Force solver and Barnes–Hut opening angle (cell size / distance).
+        // Smaller theta = more accurate and slower; 0.5 is a common default.
+        Solver solver = Solver::Naive;
+        float theta = 0.5f;
+
+        // Particle-mesh grid nodes per axis (rounded up to a power of two).
+        // p3m adds the exact short-range correction within 3 * p3mSplit cells.
+        unsigned pmGrid = 128;
+        bool  p3m = false;
+        float p3mSplit = 2.0f; // mesh cells (~1% rms force error at 2)
+
+        // Wall behaviour when bounds are on. Periodic forces use the minimum
+        // image with ParticleMesh; Naive and BarnesHut still only see the box.
+        Boundary boundary = Boundary::Reflect;
+
+        // SIMD width for the naive kernel; Auto picks the best the CPU supports.
+        // All choices give bit-identical accelerations.
+        kernels::Isa isa = kernels::Isa::Auto;
+
+        // Threads for forces, integration and bounds (0 = all hardware threads, 1 = serial)
+        unsigned threads = 0;
+
+        // true: naive rows, same bits at any thread count; false: half the pairs via symmetric tiles
+        bool deterministic = true;
+
+        // BlockTimestep: particle i steps dt / 2^level, level <= maxLevel, from
+        // dt_i = eta * min(sqrt(eps / |a|), |a| / |da/dt|), eps = sqrt(softening2)
+        Integrator integrator = Integrator::SymplecticEuler;
+        unsigned maxLevel = 8;   // finest step dt / 2^maxLevel (<= kMaxBlockLevel)
+        float eta = 0.025f;      // unitless accuracy knob; smaller = finer steps
+
+        // Out-of-plane B (T, +z out of the screen), used only by Boris:
+        // Bz = bz + bzGradX (x - boundsW/2) + bzGradY (y - boundsH/2)
+        float bz = 0.0f;
+        float bzGradX = 0.0f, bzGradY = 0.0f; // T/m
+
+        // Naive forces and shared-dt updates in Mixed / Double; Double mirrors
+        // its state into the float store. Other solvers, contacts and block steps stay Float.
+        Precision precision = Precision::Float;
+    };
+
+    // Block-timestep counters, cumulative until resetBlockStats()
+    struct BlockStats {
+        uint64_t blocks = 0;            // full dt steps taken
+        uint64_t substeps = 0;          // sub-steps at which someone was active
+        uint64_t forceEvals = 0;        // per-particle force evaluations done
+        uint64_t particleSubsteps = 0;  // N summed over those sub-steps
+        uint64_t forceEvalsShared = 0;  // evaluations a shared dt at the finest level in use would need
+        uint32_t levelCount[kMaxBlockLevel + 1] = {}; // particles per level after the last block
+
+        // Mean share of particles evaluated per sub-step
+        double activeFraction() const { return particleSubsteps ? double(forceEvals) / double(particleSubsteps) : 0.0; }
+        // Force evaluations avoided versus the shared fine step
+        double evalsSaved() const { return forceEvalsShared ? 1.0 - double(forceEvals) / double(forceEvalsShared) : 0.0; }
+    };
+
+    // Error of the active solver against the exact pairwise sum (unclamped accels)
+    struct ForceError {
+        float rmsRel = 0.f;  // sqrt( sum |a - a_exact|^2 / sum |a_exact|^2 )
+        float maxRel = 0.f;  // worst per-particle |a - a_exact| / |a_exact|
+        size_t samples = 0;  // particles compared
+    };
+
+    // Cross-check of the SoA kernels against each other and the original AoS loop
+    struct KernelCheck {
+        bool  bitExact = true;         // every supported ISA matched scalar bit-for-bit
+        float maxRelVsReference = 0.f; // worst |a - a_ref| / |a_ref| vs. the symmetric-pair loop
     };
 
     explicit Simulator(const Params& p);
@@ -34,13 +144,27 @@ public:
     // World/particles
     void clear();
     void addParticle(const Particle& p);
+    // Bulk ingestion: reserves once and fills the SoA columns from a contiguous span
+    void addParticles(std::span<const Particle> ps);
 
     // Advance physics by dt seconds
     void step(float dt);
 
+    // Same as nSteps step() calls; allocation-free after the first call at a given N
+    void advance(float dt, int nSteps);
+
     // Accessors
-    const std::vector<Particle>& particles() const { return particles_; }
-          std::vector<Particle>& particles()       { return particles_; }
+    // Gathered AoS view of the store, rebuilt lazily after any change.
+    // Prefer store() in per-frame code; this copies every particle once per step.
+    const std::vector<Particle>& particles() const;
+    const ParticleStore& store() const { return store_; }
+    size_t size() const { return store_.size(); }
+
+    Particle particle(size_t i) const { return store_.get(i); }
+    void setParticle(size_t i, const Particle& p);
+
+    // Push every particle back inside the bounds (positions only, velocities kept)
+    void clampToBounds();
 
     const Params& params() const { return P; }
           Params& params()       { return P; }
@@ -50,17 +174,116 @@ public:
     bool electrostaticsEnabled() const     { return electroOn_; }
     void setBoundsEnabled(bool on) { boundsOn_ = on; }
     bool boundsEnabled() const     { return boundsOn_; }
+    // Hard-disc contacts between particles using radius and restitution (default OFF)
+    void setCollisionsEnabled(bool on) { collisionsOn_ = on; }
+    bool collisionsEnabled() const     { return collisionsOn_; }
+
+    // Broad/narrow phase counters from the last step with collisions on
+    const CollisionSolver::Stats& collisionStats() const { return collide_.stats(); }
+
+    // Params, toggles and particles in a versioned .esck file; a bad file changes nothing
+    bool saveCheckpoint(const std::string& path) const;
+    bool loadCheckpoint(const std::string& path);
+
+    // Time forces / integration / contacts / walls of every step into p
+    // (nullptr = off). p must outlive the stepping that uses it.
+    void setProfiler(prof::Profiler* p) { prof_ = p; }
+
+    // Per-step energy, momentum and clamp counts, summed inside the force and
+    // integration passes (default OFF). Mesh and block steps give no potential.
+    void setDiagnosticsEnabled(bool on);
+    bool diagnosticsEnabled() const { return diagOn_; }
+    const StepDiagnostics& diagnostics() const { return diag_; }      // last step
+    const DiagnosticsSeries& diagnosticsHistory() const { return diagHist_; }
+    void clearDiagnostics(); // restarts step/time at 0 and empties the history
+
+    // Workers for this simulator's parallel loops (P.threads of them), for
+    // callers that want to run their own passes without a second pool
+    ThreadPool& pool();
+
+    const BlockStats& blockStats() const { return blockStats_; }
+    void resetBlockStats() { blockStats_ = BlockStats{}; }
+
+    // Compare the active solver with the naive kernel on up to maxSamples
+    // evenly spaced particles (cost O(maxSamples * N) plus one solver pass).
+    ForceError measureForceError(size_t maxSamples = 1000);
+
+    // Run every supported ISA plus the original AoS-style symmetric loop on the
+    // current particles. O(N^2) per kernel, meant for tests and benchmarks.
+    KernelCheck verifyKernels() const;
 
 private:
     Params P;
-    std::vector<Particle> particles_;
+    ParticleStore store_;
     bool electroOn_ = true;
 
-    // Internals — no collision handling between particles, only forces.
-    void computeForcesNaive(std::vector<sf::Vector2f>& acc) const; // O(N^2)
-    void integrateSymplecticEuler(float dt, std::vector<sf::Vector2f>& acc);
-    void applyBounds(); // bouncy walls only
+    mutable std::vector<Particle> view_; // particles() cache
+    mutable bool viewDirty_ = false;
+
+    // Items per parallelFor chunk. Force rows are O(N) each, so they split finer.
+    static constexpr size_t kRowGrain  = 64;
+    static constexpr size_t kLoopGrain = 8192;
+
+    // Internals — forces, integration, then contacts and walls.
+    // Accelerations are SoA as well: ax[i], ay[i] in m/s^2.
+    void computeForces(std::vector<float>& ax, std::vector<float>& ay);          // dispatch on P.solver, then clamp
+    void computeForcesUnclamped(std::vector<float>& ax, std::vector<float>& ay); // dispatch on P.solver
+    void computeForcesNaive(std::vector<float>& ax, std::vector<float>& ay);       // O(N^2), SIMD rows
+    void computeForcesBarnesHut(std::vector<float>& ax, std::vector<float>& ay);   // O(N log N)
+    void computeForcesParticleMesh(std::vector<float>& ax, std::vector<float>& ay);// O(N + G log G)
+    void computeForcesReference(std::vector<float>& ax, std::vector<float>& ay) const; // original symmetric loop
+    void computeForcesSymmetric(std::vector<float>& ax, std::vector<float>& ay);   // naive, pair tiles
+    void advanceBlock(float dt);     // one dt of hierarchical block steps
+    void computeForcesActive();      // clamped accels for active_ into bax_, bay_
+    void applyContactsAndBounds();
+    void applyBounds(); // bouncy or periodic walls
+    void advancePrecise(float dt, int nSteps);               // shared dt, any precision (SimulatorPrecise.cpp)
+    template <class Pol> void advancePreciseT(float dt, int nSteps); // Pol: precision::Float / Mixed / Double
+    void syncPrecise(); // grow the double columns and reseed entries edited in the float store
+    void particlesReplaced(); // after clear / load: reset per-particle state
 
 
     bool boundsOn_ = false; // default OFF
+    bool collisionsOn_ = false;
+
+    // Per-step scratch, reused across steps (sized in advance())
+    std::vector<float> ax_, ay_; // accelerations (m/s^2)
+
+    BarnesHutTree tree_; // rebuilt every BarnesHut step; kept to reuse its buffers
+    ParticleMesh pm_;    // grid, FFT plans and kernel cached across steps
+    CollisionSolver collide_; // spatial hash kept sorted across steps
+
+    // Block timestepping state. ax_/ay_ then hold each particle's acceleration
+    // from its last force evaluation (for the jerk estimate).
+    static constexpr uint8_t kNoLevel = 0xFF; // not stepped yet
+    std::vector<uint8_t> level_;
+    std::vector<uint32_t> active_;
+    std::vector<float> bax_, bay_;
+    BlockStats blockStats_;
+
+    prof::Profiler* prof_ = nullptr;
+
+    // Precision::Double state, and the double accelerations / potential of
+    // both Mixed and Double
+    std::vector<double> xd_, yd_, vxd_, vyd_;
+    std::vector<double> axd_, ayd_, phid_;
+
+    // Diagnostics: per-worker partial sums (one cache line each) and the
+    // potential sum per particle, sum_j q_j / R, from the last force pass
+    struct alignas(64) DiagPartial {
+        double kinetic = 0.0, qphi = 0.0, px = 0.0, py = 0.0;
+        uint32_t clampHits = 0;
+    };
+    bool diagOn_ = false;
+    bool phiValid_ = false; // phi_ was filled by the last computeForces()
+    std::vector<float> phi_;
+    std::vector<DiagPartial> diagPart_;
+    StepDiagnostics diag_;
+    DiagnosticsSeries diagHist_;
+    float* potentialOut();               // phi_ when diagnostics want it, else null
+    void beginDiagnostics();             // zero the partials
+    void endDiagnostics(double time, bool potential); // reduce, stamp and record
+    double diagClock_ = 0.0; // s since diagnostics were switched on
+
+    std::unique_ptr<ThreadPool> pool_; // created on first use, resized when P.threads changes
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Persistent fork-join pool; the caller works as worker 0, no allocation per
+// call. One caller at a time, and bodies must not re-enter the pool.
+class ThreadPool {
+public:
+    // threads = total threads including the caller; 0 = std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that may run a body (workers + caller)
+    unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // Calls fn(begin, end, worker) over [0, n). worker is in [0, size()).
+    // Runs inline when the pool has no workers or n fits in one chunk.
+    template <class F>
+    void parallelFor(size_t n, size_t grain, F&& fn) {
+        if (n == 0) return;
+        if (grain == 0) grain = 1;
+        if (workers_.empty() || n <= grain) { fn(size_t(0), n, 0u); return; }
+        using Fn = std::remove_reference_t<F>;
+        run(n, grain, [](void* ctx, size_t b, size_t e, unsigned w) { (*static_cast<Fn*>(ctx))(b, e, w); },
+            const_cast<void*>(static_cast<const void*>(&fn)));
+    }
+
+    static unsigned resolveThreads(unsigned requested);
+
+private:
+    using Body = void (*)(void*, size_t, size_t, unsigned);
+
+    void run(size_t n, size_t grain, Body body, void* ctx);
+    void work(unsigned worker);
+    void workerLoop(unsigned worker);
+
+    std::vector<std::thread> workers_;
+
+    std::mutex m_;
+    std::condition_variable wake_, done_;
+    uint64_t generation_ = 0; // bumped per job, guarded by m_
+    bool stop_ = false;
+
+    // current job
+    Body body_ = nullptr;
+    void* ctx_ = nullptr;
+    size_t n_ = 0, grain_ = 1;
+    std::atomic<size_t> next_{0};
+    std::atomic<unsigned> pending_{0}; // workers still inside the job
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "MappedFile.hpp"
+#include "Simulator.hpp"
+
+// .estraj: FileHeader, frames (keyframes of raw floats or int16 deltas from the
+// last keyframe), then an index written on close; any frame decodes from two blocks.
+namespace traj {
+
+constexpr char     kMagic[8]  = { 'E', 'S', 'T', 'R', 'A', 'J', '\r', '\n' };
+constexpr uint32_t kVersion   = 2;
+constexpr uint32_t kKeyTag    = 0x59454b46; // "FKEY"
+constexpr uint32_t kDeltaTag  = 0x4c454446; // "FDEL"
+
+struct FileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t headerBytes;   // sizeof(FileHeader)
+    uint64_t frameCount;    // patched on close; 0 while recording
+    uint64_t indexOffset;   // patched on close; 0 while recording
+    float    dt;            // s per step
+    uint32_t every;         // steps per frame
+    float    quantum;       // m per delta unit
+    uint32_t keyInterval;   // frames per keyframe, at most
+
+    // Simulator::Params when recording started
+    float    k, softening2, boundsW, boundsH, restitution, maxAccel, theta, p3mSplit;
+    uint32_t solver, boundary, pmGrid, p3m;
+    // Version 2 (version 1 files load these as Params defaults)
+    uint32_t integrator, maxLevel;
+    float    eta, bz, bzGradX, bzGradY;
+    uint32_t precision;
+    uint32_t reserved[1];
+};
+
+struct FrameHeader {
+    uint32_t tag;           // kKeyTag or kDeltaTag
+    uint32_t n;             // particles
+    uint64_t step;          // simulation step of this frame
+    double   time;          // s
+    uint64_t payloadBytes;  // bytes after this header, multiple of 8
+    uint64_t keyOffset;     // file offset of the keyframe this frame is relative to
+};
+
+struct IndexEntry {
+    uint64_t offset;        // FrameHeader of this frame
+    uint64_t keyOffset;     // FrameHeader of its keyframe
+};
+
+static_assert(sizeof(FileHeader) == 128 && sizeof(FrameHeader) == 40 && sizeof(IndexEntry) == 16);
+static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<FrameHeader>);
+
+} // namespace traj
+
+// Encodes on the caller's thread, writes on a background thread
+class TrajectoryWriter {
+public:
+    struct Options {
+        unsigned every = 1;         // record every k-th step
+        unsigned keyInterval = 64;  // at most this many frames between keyframes
+        float quantum = 1e-4f;      // m; delta range is +-32767 quanta from the keyframe
+    };
+
+    TrajectoryWriter() = default;
+    ~TrajectoryWriter(); // close()
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    bool open(const std::string& path, const Simulator::Params& P, float dt, const Options& o);
+    void close(); // flushes, writes the index and patches the header
+    bool isOpen() const { return file_ != nullptr; }
+
+    // Same as sim.advance(dt, nSteps), recording a frame after every
+    // `every`-th step (and the starting state before the first step).
+    void advance(Simulator& sim, float dt, int nSteps);
+
+    // Append the current state as a frame at the writer's step count.
+    void record(const ParticleStore& s);
+
+    uint64_t frames() const { return index_.size(); }
+    uint64_t bytes() const  { return offset_; }
+
+private:
+    void writeKey(const ParticleStore& s, std::vector<uint8_t>& out);
+    bool writeDelta(const ParticleStore& s, std::vector<uint8_t>& out);
+    void submit(std::vector<uint8_t>&& block);
+    void ioLoop();
+
+    std::FILE* file_ = nullptr;
+    traj::FileHeader header_{};
+    Options opt_;
+    uint64_t steps_ = 0;
+    bool started_ = false;
+
+    uint64_t offset_ = 0;                  // bytes submitted so far
+    std::vector<traj::IndexEntry> index_;
+    uint64_t keyOffset_ = 0;
+    unsigned sinceKey_ = 0;
+    std::vector<float> keyX_, keyY_;       // positions in the current keyframe
+
+    // Background writer: encoded blocks go through full_, buffers come back via free_
+    std::thread io_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<std::vector<uint8_t>> full_;
+    std::vector<std::vector<uint8_t>> free_;
+    bool stopIo_ = false;
+    bool ioFailed_ = false;
+};
+
+// Memory-maps a trajectory file. Keyframes are served as pointers into the
+// mapping; delta frames are decoded into one reused buffer.
+class TrajectoryReader {
+public:
+    struct Frame {
+        const float* x = nullptr;
+        const float* y = nullptr;
+        const float* radius = nullptr;
+        const Rgba8* color = nullptr;
+        size_t n = 0;
+        uint64_t step = 0;
+        double time = 0.0; // s
+    };
+
+    TrajectoryReader() = default;
+    ~TrajectoryReader(); // close()
+
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    // Rebuilds the index by walking the frames when the file was never closed
+    // (e.g. the recorder crashed). Returns false if the file is not a trajectory.
+    bool open(const std::string& path);
+    void close();
+
+    const traj::FileHeader& header() const { return *reinterpret_cast<const traj::FileHeader*>(data_); }
+    Simulator::Params params() const;
+    size_t frameCount() const { return index_.size(); }
+
+    // Frame i in O(n). Pointers stay valid until the next frame() or close().
+    Frame frame(size_t i);
+
+private:
+    const traj::FrameHeader* at(uint64_t offset) const;
+
+    MappedFile map_;
+    const uint8_t* data_ = nullptr; // map_.data() while open
+    size_t size_ = 0;
+    std::vector<traj::IndexEntry> index_;
+    std::vector<float> x_, y_; // decoded delta frame
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+
+// Lock-free SPSC triple buffer: the reader keeps its buffer until the next read(),
+// neither side waits and skipped frames are overwritten.
+template <class T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& writeBuffer() { return buf_[back_]; }
+
+    void publish() {
+        const unsigned prev = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_ = prev & kIndex;
+    }
+
+    // Reader side. `updated` (optional) is set when a newer buffer was taken.
+    const T& read(bool* updated = nullptr) {
+        bool fresh = (middle_.load(std::memory_order_relaxed) & kFresh) != 0;
+        if (fresh) {
+            const unsigned prev = middle_.exchange(front_, std::memory_order_acq_rel);
+            front_ = prev & kIndex;
+        }
+        if (updated) *updated = fresh;
+        return buf_[front_];
+    }
+
+private:
+    static constexpr unsigned kIndex = 0x3u;
+    static constexpr unsigned kFresh = 0x4u;
+
+    T buf_[3];
+    unsigned back_  = 0;                 // writer-owned
+    unsigned front_ = 1;                 // reader-owned
+    std::atomic<unsigned> middle_{2};    // shared, plus the fresh bit
+};
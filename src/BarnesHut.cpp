@@ -0,0 +1,186 @@
+#include "BarnesHut.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Spread the low 16 bits of v so there is a zero bit between each of them.
+static inline uint32_t spreadBits(uint32_t v) {
+    v &= 0x0000FFFFu;
+    v = (v | (v << 8)) & 0x00FF00FFu;
+    v = (v | (v << 4)) & 0x0F0F0F0Fu;
+    v = (v | (v << 2)) & 0x33333333u;
+    v = (v | (v << 1)) & 0x55555555u;
+    return v;
+}
+
+void BarnesHutTree::build(const float* x, const float* y, const float* q, size_t n,
+                          float boundsW, float boundsH) {
+    nodes_.clear();
+    if (n == 0) return;
+
+    // Root square: world rectangle grown to include escaped particles
+    float minX = 0.f, minY = 0.f, maxX = boundsW, maxY = boundsH;
+    for (size_t i = 0; i < n; ++i) {
+        minX = std::min(minX, x[i]); maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]); maxY = std::max(maxY, y[i]);
+    }
+    const float size = std::max(maxX - minX, maxY - minY) * 1.0001f + 1e-6f;
+    const float toGrid = 65536.f / size;
+
+    // Sort by Morton code; key = code<<32 | index keeps the sort stable
+    keys_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto gx = static_cast<uint32_t>(std::clamp((x[i] - minX) * toGrid, 0.f, 65535.f));
+        auto gy = static_cast<uint32_t>(std::clamp((y[i] - minY) * toGrid, 0.f, 65535.f));
+        uint32_t code = spreadBits(gx) | (spreadBits(gy) << 1);
+        keys_[i] = (uint64_t(code) << 32) | uint64_t(i);
+    }
+    std::sort(keys_.begin(), keys_.end());
+
+    code_.resize(n); order_.resize(n); slot_.resize(n);
+    x_.resize(n); y_.resize(n); q_.resize(n);
+    for (size_t s = 0; s < n; ++s) {
+        const auto i = static_cast<uint32_t>(keys_[s] & 0xFFFFFFFFu);
+        code_[s]  = static_cast<uint32_t>(keys_[s] >> 32);
+        order_[s] = i;
+        slot_[i]  = static_cast<uint32_t>(s);
+        x_[s] = x[i];
+        y_[s] = y[i];
+        q_[s] = q[i];
+    }
+
+    nodes_.reserve(2 * n / kLeafSize + 16);
+    nodes_.push_back({});
+    buildNode(0, 0, static_cast<uint32_t>(n), 0, minX, minY, size);
+}
+
+void BarnesHutTree::buildNode(uint32_t id, uint32_t begin, uint32_t end, int depth,
+                              float minX, float minY, float size) {
+    nodes_[id].size = size;
+    nodes_[id].begin = begin; nodes_[id].end = end;
+    nodes_[id].child = -1; nodes_[id].nChild = 0;
+
+    float aq = 0.f, q = 0.f, cx = 0.f, cy = 0.f, dx = 0.f, dy = 0.f;
+
+    if (end - begin <= kLeafSize || depth == kMaxDepth) {
+        for (uint32_t s = begin; s < end; ++s) {
+            float w = std::fabs(q_[s]);
+            aq += w; q += q_[s];
+            cx += w * x_[s]; cy += w * y_[s];
+        }
+        if (aq > 0.f) { cx /= aq; cy /= aq; }
+        else          { cx = minX + 0.5f * size; cy = minY + 0.5f * size; }
+        for (uint32_t s = begin; s < end; ++s) {
+            dx += q_[s] * (x_[s] - cx);
+            dy += q_[s] * (y_[s] - cy);
+        }
+    } else {
+        // Split the sorted range into (up to) four quadrants by the next 2 code bits.
+        // Bit 0 of each pair is x, bit 1 is y.
+        const int shift = 2 * (kMaxDepth - 1 - depth);
+        uint32_t cut[5]; cut[0] = begin; cut[4] = end;
+        for (uint32_t c = 1; c < 4; ++c) {
+            cut[c] = static_cast<uint32_t>(std::partition_point(
+                code_.begin() + cut[c - 1], code_.begin() + end,
+                [&](uint32_t code) { return ((code >> shift) & 3u) < c; }) - code_.begin());
+        }
+
+        // Reserve contiguous child slots before recursing
+        const auto first = static_cast<uint32_t>(nodes_.size());
+        uint32_t nChild = 0;
+        for (int c = 0; c < 4; ++c) if (cut[c + 1] > cut[c]) ++nChild;
+        nodes_.resize(nodes_.size() + nChild);
+        nodes_[id].child  = static_cast<int32_t>(first);
+        nodes_[id].nChild = nChild;
+
+        const float half = 0.5f * size;
+        uint32_t k = first;
+        for (uint32_t c = 0; c < 4; ++c) {
+            if (cut[c + 1] == cut[c]) continue;
+            buildNode(k++, cut[c], cut[c + 1], depth + 1,
+                      minX + ((c & 1u) ? half : 0.f), minY + ((c & 2u) ? half : 0.f), half);
+        }
+
+        // Combine children: |q|-weighted centre, then shift dipoles onto it
+        for (uint32_t c = first; c < first + nChild; ++c) {
+            const Node& ch = nodes_[c];
+            aq += ch.aq; q += ch.q;
+            cx += ch.aq * ch.cx; cy += ch.aq * ch.cy;
+        }
+        if (aq > 0.f) { cx /= aq; cy /= aq; }
+        else          { cx = minX + 0.5f * size; cy = minY + 0.5f * size; }
+        for (uint32_t c = first; c < first + nChild; ++c) {
+            const Node& ch = nodes_[c];
+            dx += ch.dx + ch.q * (ch.cx - cx);
+            dy += ch.dy + ch.q * (ch.cy - cy);
+        }
+    }
+
+    Node& nd = nodes_[id];
+    nd.aq = aq; nd.q = q;
+    nd.cx = cx; nd.cy = cy;
+    nd.dx = dx; nd.dy = dy;
+}
+
+sf::Vector2f BarnesHutTree::field(size_t self, float theta, float soft2) const {
+    float unused = 0.f;
+    return walk<false>(self, theta, soft2, unused);
+}
+
+sf::Vector2f BarnesHutTree::field(size_t self, float theta, float soft2, float& phi) const {
+    phi = 0.f;
+    return walk<true>(self, theta, soft2, phi);
+}
+
+template <bool Pot>
+sf::Vector2f BarnesHutTree::walk(size_t self, float theta, float soft2, float& phi) const {
+    if (nodes_.empty()) return {0.f, 0.f};
+
+    const uint32_t me = slot_[self];
+    const float px = x_[me], py = y_[me];
+    const float theta2 = theta * theta;
+    float ex = 0.f, ey = 0.f;
+
+    uint32_t stack[4 * kMaxDepth + 8];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& nd = nodes_[stack[--top]];
+        if (nd.aq == 0.f) continue; // uncharged cell
+
+        const bool containsSelf = me >= nd.begin && me < nd.end;
+
+        if (nd.child < 0) {
+            // Leaf: direct softened sum
+            for (uint32_t s = nd.begin; s < nd.end; ++s) {
+                if (s == me) continue;
+                float rx = px - x_[s], ry = py - y_[s];
+                float r2 = rx*rx + ry*ry + soft2;
+                float invR  = 1.0f / std::sqrt(r2);
+                float invR3 = invR * invR * invR;
+                ex += q_[s] * rx * invR3;
+                ey += q_[s] * ry * invR3;
+                if constexpr (Pot) phi += q_[s] * invR;
+            }
+            continue;
+        }
+
+        const float rx = px - nd.cx, ry = py - nd.cy;
+        const float d2 = rx*rx + ry*ry;
+        if (!containsSelf && nd.size * nd.size < theta2 * d2) {
+            // Far cell: monopole + dipole about the |q| centre
+            float r2 = d2 + soft2;
+            float invR  = 1.0f / std::sqrt(r2);
+            float invR3 = invR * invR * invR;
+            float invR5 = invR3 * invR * invR;
+            float pr = nd.dx * rx + nd.dy * ry;
+            ex += nd.q * rx * invR3 + 3.f * pr * rx * invR5 - nd.dx * invR3;
+            ey += nd.q * ry * invR3 + 3.f * pr * ry * invR5 - nd.dy * invR3;
+            if constexpr (Pot) phi += nd.q * invR + pr * invR3;
+        } else {
+            for (uint32_t c = 0; c < nd.nChild; ++c)
+                stack[top++] = static_cast<uint32_t>(nd.child) + c;
+        }
+    }
+    return {ex, ey};
+}
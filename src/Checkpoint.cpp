@@ -0,0 +1,175 @@
+#include "Simulator.hpp"
+#include "MappedFile.hpp"
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+// .esck layout (native little-endian):
+//   Header (128 bytes)
+//   x, y, vx, vy, q, mass, radius   float[n] each, every column padded to 8 bytes
+//   color                           Rgba8[n]
+// invMass is rebuilt from mass on load. Version 2 adds the integrator, maxLevel
+// and eta; version 1 files load as SymplecticEuler with default maxLevel / eta.
+namespace {
+
+constexpr char     kMagic[8] = { 'E', 'S', 'C', 'K', 'P', 'T', '\r', '\n' };
+constexpr uint32_t kVersion  = 2;
+
+struct Header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint64_t n;
+
+    // Params
+    float    k, softening2, boundsW, boundsH, restitution, maxAccel, theta, p3mSplit;
+    uint32_t solver, boundary, pmGrid, p3m, isa, threads, deterministic;
+
+    // Toggles
+    uint32_t electroOn, boundsOn, collisionsOn;
+
+    // Magnetic field (zero in files written before it existed)
+    float    bz, bzGradX, bzGradY;
+
+    uint32_t precision; // 0 (Float) in older files; state is saved as float either way
+
+    // Version 2
+    uint32_t integrator, maxLevel;
+    float    eta;
+
+    uint32_t reserved[1];
+};
+static_assert(sizeof(Header) == 128 && std::is_trivially_copyable_v<Header>);
+
+// Every enum field names a value this build knows
+bool enumsValid(const Header& h) {
+    return h.solver    <= uint32_t(Simulator::Solver::ParticleMesh)
+        && h.boundary  <= uint32_t(Simulator::Boundary::Periodic)
+        && h.isa       <= uint32_t(kernels::Isa::AVX2)
+        && h.precision <= uint32_t(Simulator::Precision::Double)
+        && h.integrator <= uint32_t(Simulator::Integrator::Boris);
+}
+
+size_t columnBytes(size_t n, size_t elem) { return (n * elem + 7) & ~size_t(7); }
+
+size_t fileBytes(size_t n) {
+    return sizeof(Header) + 7 * columnBytes(n, sizeof(float)) + columnBytes(n, sizeof(Rgba8));
+}
+
+} // namespace
+
+bool Simulator::saveCheckpoint(const std::string& path) const {
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version     = kVersion;
+    h.headerBytes = sizeof(Header);
+    h.n           = store_.size();
+    h.k           = P.k;
+    h.softening2  = P.softening2;
+    h.boundsW     = P.boundsW;
+    h.boundsH     = P.boundsH;
+    h.restitution = P.restitution;
+    h.maxAccel    = P.maxAccel;
+    h.theta       = P.theta;
+    h.p3mSplit    = P.p3mSplit;
+    h.solver      = uint32_t(P.solver);
+    h.boundary    = uint32_t(P.boundary);
+    h.pmGrid      = P.pmGrid;
+    h.p3m         = P.p3m;
+    h.isa         = uint32_t(P.isa);
+    h.threads     = P.threads;
+    h.deterministic = P.deterministic;
+    h.bz          = P.bz;
+    h.bzGradX     = P.bzGradX;
+    h.bzGradY     = P.bzGradY;
+    h.precision   = uint32_t(P.precision);
+    h.integrator  = uint32_t(P.integrator);
+    h.maxLevel    = P.maxLevel;
+    h.eta         = P.eta;
+    h.electroOn    = electroOn_;
+    h.boundsOn     = boundsOn_;
+    h.collisionsOn = collisionsOn_;
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+
+    static const uint8_t zeros[8] = {};
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    auto column = [&](const void* data, size_t elem) {
+        const size_t bytes = store_.size() * elem;
+        if (bytes) ok = ok && std::fwrite(data, 1, bytes, f) == bytes;
+        const size_t pad = columnBytes(store_.size(), elem) - bytes;
+        if (pad) ok = ok && std::fwrite(zeros, 1, pad, f) == pad;
+    };
+    const auto& S = store_;
+    for (const auto* col : { &S.x, &S.y, &S.vx, &S.vy, &S.q, &S.mass, &S.radius })
+        column(col->data(), sizeof(float));
+    column(S.color.data(), sizeof(Rgba8));
+
+    ok = (std::fclose(f) == 0) && ok;
+    return ok;
+}
+
+bool Simulator::loadCheckpoint(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(Header)) return false;
+
+    Header h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version < 1 || h.version > kVersion
+        || h.headerBytes != sizeof(Header) || h.n > (file.size() / 4) || file.size() < fileBytes(size_t(h.n))
+        || !enumsValid(h))
+        return false;
+
+    const size_t n = size_t(h.n);
+    const uint8_t* p = file.data() + sizeof(Header);
+    auto column = [&](auto& out) {
+        using T = typename std::decay_t<decltype(out)>::value_type;
+        out.resize(n);
+        if (n) std::memcpy(out.data(), p, n * sizeof(T));
+        p += columnBytes(n, sizeof(T));
+    };
+
+    ParticleStore S;
+    for (auto* col : { &S.x, &S.y, &S.vx, &S.vy, &S.q, &S.mass, &S.radius }) column(*col);
+    column(S.color);
+    S.invMass.resize(n);
+    for (size_t i = 0; i < n; ++i) S.invMass[i] = 1.0f / S.mass[i];
+
+    P.k           = h.k;
+    P.softening2  = h.softening2;
+    P.boundsW     = h.boundsW;
+    P.boundsH     = h.boundsH;
+    P.restitution = h.restitution;
+    P.maxAccel    = h.maxAccel;
+    P.theta       = h.theta;
+    P.p3mSplit    = h.p3mSplit;
+    P.solver      = Solver(h.solver);
+    P.boundary    = Boundary(h.boundary);
+    P.pmGrid      = h.pmGrid;
+    P.p3m         = h.p3m != 0;
+    P.isa         = kernels::Isa(h.isa);
+    P.threads     = h.threads;
+    P.deterministic = h.deterministic != 0;
+    P.bz          = h.bz;
+    P.bzGradX     = h.bzGradX;
+    P.bzGradY     = h.bzGradY;
+    P.precision   = Precision(h.precision);
+    if (h.version >= 2) {
+        P.integrator = Integrator(h.integrator);
+        P.maxLevel   = h.maxLevel;
+        P.eta        = h.eta;
+    } else {
+        const Params defaults;
+        P.integrator = Integrator::SymplecticEuler;
+        P.maxLevel   = defaults.maxLevel;
+        P.eta        = defaults.eta;
+    }
+    electroOn_    = h.electroOn != 0;
+    boundsOn_     = h.boundsOn != 0;
+    collisionsOn_ = h.collisionsOn != 0;
+
+    store_ = std::move(S);
+    particlesReplaced();
+    return true;
+}
@@ -0,0 +1,163 @@
+#include "Collisions.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+static inline int32_t cellCoord(float v, float invCell) {
+    // Clamp so particles that escaped the box cannot overflow the cell index
+    return static_cast<int32_t>(std::floor(std::clamp(v * invCell, -1e9f, 1e9f)));
+}
+
+uint32_t CollisionSolver::bucketOf(int32_t cx, int32_t cy) const {
+    return ((uint32_t(cx) * 73856093u) ^ (uint32_t(cy) * 19349663u)) & mask_;
+}
+
+void CollisionSolver::sortByBucket(const ParticleStore& s) {
+    const size_t n = s.size();
+    float maxR = 0.f;
+    for (float r : s.radius) maxR = std::max(maxR, r);
+    const float cell = 2.0f * maxR;
+
+    size_t table = 64;
+    while (table < 2 * n) table <<= 1;
+
+    const bool reuse = order_.size() == n && cell == cell_ && uint32_t(table - 1) == mask_;
+    cell_ = cell;
+    invCell_ = 1.0f / cell;
+    mask_ = uint32_t(table - 1);
+
+    if (reuse) {
+        // Pull out the particles whose bucket changed, compact the rest (still
+        // sorted), sort the movers and merge them back: O(N + m log m).
+        moved_.clear();
+        size_t kept = 0;
+        for (size_t a = 0; a < n; ++a) {
+            const uint32_t p = order_[a];
+            const int32_t cx = cellCoord(s.x[p], invCell_), cy = cellCoord(s.y[p], invCell_);
+            const uint32_t k = bucketOf(cx, cy);
+            if (k != key_[a]) { moved_.push_back({ k, p, cx, cy }); continue; }
+            order_[kept] = p; key_[kept] = k; cellX_[kept] = cx; cellY_[kept] = cy;
+            ++kept;
+        }
+        std::sort(moved_.begin(), moved_.end(), [](const Moved& u, const Moved& v) {
+            return u.key != v.key ? u.key < v.key : u.p < v.p;
+        });
+        size_t a = kept, m = moved_.size(), out = n;
+        while (m > 0) { // merge from the back, in place
+            const Moved& mv = moved_[m - 1];
+            --out;
+            if (a > 0 && key_[a - 1] > mv.key) {
+                --a;
+                order_[out] = order_[a]; key_[out] = key_[a]; cellX_[out] = cellX_[a]; cellY_[out] = cellY_[a];
+            } else {
+                order_[out] = mv.p; key_[out] = mv.key; cellX_[out] = mv.cx; cellY_[out] = mv.cy;
+                --m;
+            }
+        }
+        stats_.moved = moved_.size();
+
+        bucketStart_.assign(table + 1, 0);
+        for (size_t i = 0; i < n; ++i) ++bucketStart_[key_[i] + 1];
+        for (size_t bk = 0; bk < table; ++bk) bucketStart_[bk + 1] += bucketStart_[bk];
+        return;
+    }
+
+    // Full counting sort by bucket
+    stats_.fullRebuild = true;
+    stats_.moved = n;
+    bucketStart_.assign(table + 1, 0);
+    order_.resize(n); key_.resize(n); cellX_.resize(n); cellY_.resize(n); tmp_.resize(n);
+    for (size_t p = 0; p < n; ++p) {
+        tmp_[p] = bucketOf(cellCoord(s.x[p], invCell_), cellCoord(s.y[p], invCell_));
+        ++bucketStart_[tmp_[p] + 1];
+    }
+    for (size_t b = 0; b < table; ++b) bucketStart_[b + 1] += bucketStart_[b];
+    // Scatter using bucketStart_ as the cursor, then shift it back into place
+    for (size_t p = 0; p < n; ++p) order_[bucketStart_[tmp_[p]]++] = uint32_t(p);
+    for (size_t b = table; b > 0; --b) bucketStart_[b] = bucketStart_[b - 1];
+    bucketStart_[0] = 0;
+    for (size_t a = 0; a < n; ++a) {
+        const uint32_t p = order_[a];
+        key_[a] = tmp_[p];
+        cellX_[a] = cellCoord(s.x[p], invCell_);
+        cellY_[a] = cellCoord(s.y[p], invCell_);
+    }
+}
+
+void CollisionSolver::findContacts(const ParticleStore& s, ThreadPool& pool) {
+    stats_ = Stats{};
+    contacts_.clear();
+    const size_t n = s.size();
+    if (n < 2 || *std::max_element(s.radius.begin(), s.radius.end()) <= 0.f) return;
+
+    sortByBucket(s);
+
+    perWorker_.resize(pool.size());
+    candidates_.assign(pool.size(), 0);
+    for (auto& v : perWorker_) v.clear();
+
+    // Each particle checks the 3x3 cells around its own and keeps pairs with
+    // j > i, so every touching pair is reported exactly once.
+    pool.parallelFor(n, 1024, [&](size_t b, size_t e, unsigned w) {
+        auto& out = perWorker_[w];
+        size_t tested = 0;
+        for (size_t a = b; a < e; ++a) {
+            const uint32_t i = order_[a];
+            const float xi = s.x[i], yi = s.y[i], ri = s.radius[i];
+            for (int32_t dy = -1; dy <= 1; ++dy) {
+                for (int32_t dx = -1; dx <= 1; ++dx) {
+                    const int32_t ncx = cellX_[a] + dx, ncy = cellY_[a] + dy;
+                    const uint32_t bk = bucketOf(ncx, ncy);
+                    for (uint32_t t = bucketStart_[bk]; t < bucketStart_[bk + 1]; ++t) {
+                        if (cellX_[t] != ncx || cellY_[t] != ncy) continue; // hash collision
+                        const uint32_t j = order_[t];
+                        if (j <= i) continue;
+                        ++tested;
+                        const float rx = s.x[j] - xi, ry = s.y[j] - yi;
+                        const float rr = ri + s.radius[j];
+                        if (rx*rx + ry*ry < rr*rr) out.push_back({ i, j });
+                    }
+                }
+            }
+        }
+        candidates_[w] += tested;
+    });
+
+    for (unsigned w = 0; w < perWorker_.size(); ++w) {
+        contacts_.insert(contacts_.end(), perWorker_[w].begin(), perWorker_[w].end());
+        stats_.candidates += candidates_[w];
+    }
+    std::sort(contacts_.begin(), contacts_.end(), [](const Contact& a, const Contact& b) {
+        return a.i != b.i ? a.i < b.i : a.j < b.j;
+    });
+    stats_.contacts = contacts_.size();
+}
+
+void CollisionSolver::resolve(ParticleStore& s, float restitution) const {
+    for (const Contact& c : contacts_) {
+        const uint32_t i = c.i, j = c.j;
+        float nx = s.x[j] - s.x[i], ny = s.y[j] - s.y[i]; // i -> j
+        const float d2 = nx*nx + ny*ny;
+        const float rr = s.radius[i] + s.radius[j];
+        if (d2 >= rr*rr) continue; // already pushed apart by an earlier contact
+        const float wi = s.invMass[i], wj = s.invMass[j];
+        const float wsum = wi + wj;
+        if (!(wsum > 0.f)) continue;
+
+        float d = std::sqrt(d2);
+        if (d > 0.f) { nx /= d; ny /= d; }
+        else         { nx = 1.f; ny = 0.f; } // coincident: pick any normal
+
+        // Positional split so the pair no longer overlaps (m)
+        const float push = (rr - d) / wsum;
+        s.x[i] -= nx * push * wi;  s.y[i] -= ny * push * wi;
+        s.x[j] += nx * push * wj;  s.y[j] += ny * push * wj;
+
+        // Normal impulse (N·s), only when approaching
+        const float vn = (s.vx[j] - s.vx[i]) * nx + (s.vy[j] - s.vy[i]) * ny;
+        if (vn >= 0.f) continue;
+        const float J = -(1.0f + restitution) * vn / wsum;
+        s.vx[i] -= J * wi * nx;  s.vy[i] -= J * wi * ny;
+        s.vx[j] += J * wj * nx;  s.vy[j] += J * wj * ny;
+    }
+}
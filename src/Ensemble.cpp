@@ -0,0 +1,252 @@
+#include "Ensemble.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct Energy { double e = 0.0, px = 0.0, py = 0.0; };
+
+// KE + softened pair PE and momentum, in double. O(N^2); rows split over
+// `pool` when given (split runs the diagnostics cannot cover), serial otherwise.
+Energy measure(const Simulator& sim, bool electro, ThreadPool* pool) {
+    const auto& S = sim.store();
+    const auto& P = sim.params();
+    const size_t n = S.size();
+    Energy en;
+    for (size_t i = 0; i < n; ++i) {
+        const double vx = S.vx[i], vy = S.vy[i], m = S.mass[i];
+        en.e  += 0.5 * m * (vx * vx + vy * vy);
+        en.px += m * vx;
+        en.py += m * vy;
+    }
+    if (!electro || n < 2) return en;
+
+    auto rows = [&](size_t b, size_t e) {
+        double pe = 0.0;
+        for (size_t i = b; i < e; ++i) {
+            double row = 0.0;
+            for (size_t j = i + 1; j < n; ++j) {
+                const double rx = double(S.x[i]) - S.x[j], ry = double(S.y[i]) - S.y[j];
+                const double r2 = rx * rx + ry * ry + double(P.softening2);
+                if (r2 > 0.0) row += double(S.q[j]) / std::sqrt(r2);
+            }
+            pe += double(S.q[i]) * row;
+        }
+        return pe;
+    };
+
+    double pe = 0.0;
+    if (pool && pool->size() > 1) {
+        std::vector<double> part(pool->size(), 0.0);
+        pool->parallelFor(n, 64, [&](size_t b, size_t e, unsigned w) { part[w] += rows(b, e); });
+        for (double p : part) pe += p;
+    } else {
+        pe = rows(0, n);
+    }
+    en.e += double(P.k) * pe;
+    return en;
+}
+
+struct Live {
+    Ensemble::Run* run = nullptr;
+    Ensemble::Summary* out = nullptr;
+    std::unique_ptr<Simulator> sim;
+    int done = 0; // steps taken
+    bool finished = false;
+    bool diag = false; // energy from the simulator's per-step diagnostics
+};
+
+// Split runs whose force pass can also sum the potential
+bool diagnosable(const Ensemble::Run& r) {
+    return !r.electrostatics || (r.params.solver != Simulator::Solver::ParticleMesh
+                                 && r.params.integrator != Simulator::Integrator::BlockTimestep);
+}
+
+void start(Live& L, bool split) {
+    Ensemble::Run& r = *L.run;
+    L.sim = std::make_unique<Simulator>(r.params);
+    Simulator& s = *L.sim;
+    s.setElectrostaticsEnabled(r.electrostatics);
+    s.setBoundsEnabled(r.bounds);
+    s.setCollisionsEnabled(r.collisions);
+    s.addParticles(r.particles);
+    r.particles = {}; // the store has them now
+
+    Ensemble::Summary& out = *L.out;
+    out.name = r.name;
+    out.n    = s.size();
+    L.diag = split && diagnosable(r);
+    if (L.diag) { // e0 comes with the first step
+        s.setDiagnosticsEnabled(true);
+        return;
+    }
+    const Energy e0 = measure(s, r.electrostatics, split ? &s.pool() : nullptr);
+    out.e0  = e0.e;
+    out.px0 = e0.px;
+    out.py0 = e0.py;
+}
+
+// Drift of one energy sample against e0
+void sampleDrift(Ensemble::Summary& out, double e) {
+    const double scale = std::fabs(out.e0) > 0.0 ? std::fabs(out.e0) : 1.0;
+    out.maxDrift = std::max(out.maxDrift, std::fabs(e - out.e0) / scale);
+}
+
+// Up to `slice` more steps; true when the run is finished (and summarised)
+bool stepSlice(Live& L, int slice, const Ensemble::Options& o, bool split) {
+    Ensemble::Run& r = *L.run;
+    Ensemble::Summary& out = *L.out;
+    if (!L.sim) start(L, split);
+    Simulator& s = *L.sim;
+
+    int todo = std::min(slice, r.steps - L.done);
+    if (o.sampleEvery > 0) todo = std::min(todo, o.sampleEvery - L.done % o.sampleEvery);
+    if (L.diag) todo = std::min(todo, int(s.diagnosticsHistory().capacity())); // read every step back
+
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    s.advance(r.dt, todo);
+    out.wallSeconds += std::chrono::duration<double>(clock::now() - t0).count();
+    L.done += todo;
+
+    const bool finished = L.done >= r.steps;
+    const bool sample = finished || (o.sampleEvery > 0 && L.done % o.sampleEvery == 0);
+    if (L.diag) {
+        // Every step of this slice, each at its force time
+        const DiagnosticsSeries& h = s.diagnosticsHistory();
+        const size_t from = h.size() - std::min(h.size(), size_t(todo));
+        if (L.done == todo && !h.empty()) {
+            out.e0  = h[from].total();
+            out.px0 = h[from].px;
+            out.py0 = h[from].py;
+        }
+        for (size_t k = from; k < h.size(); ++k) sampleDrift(out, h[k].total());
+        if (finished && !h.empty()) {
+            const double scale = std::fabs(out.e0) > 0.0 ? std::fabs(out.e0) : 1.0;
+            out.e1    = h.back().total();
+            out.drift = (out.e1 - out.e0) / scale;
+            out.px1   = h.back().px;
+            out.py1   = h.back().py;
+        }
+    } else if (sample) {
+        const Energy e = measure(s, r.electrostatics, split ? &s.pool() : nullptr);
+        const double scale = std::fabs(out.e0) > 0.0 ? std::fabs(out.e0) : 1.0;
+        sampleDrift(out, e.e);
+        if (finished) {
+            out.e1    = e.e;
+            out.drift = (e.e - out.e0) / scale;
+            out.px1   = e.px;
+            out.py1   = e.py;
+        }
+    }
+    if (!finished) return false;
+
+    L.finished = true;
+    out.steps   = L.done;
+    out.simTime = double(L.done) * r.dt;
+    if (!o.finalDir.empty())
+        out.savedFinal = s.saveCheckpoint(o.finalDir + "/" + r.name + ".esck");
+    L.sim.reset(); // free the particles as soon as the run is done
+    return true;
+}
+
+// Owner pushes/pops at the back, thieves take from the front
+struct TaskDeque {
+    std::mutex m;
+    std::deque<uint32_t> q;
+};
+
+} // namespace
+
+std::vector<Ensemble::Summary> Ensemble::run(const Options& o) {
+    const size_t count = runs_.size();
+    std::vector<Summary> out(count);
+    std::vector<Live> live(count);
+    for (size_t i = 0; i < count; ++i) { live[i].run = &runs_[i]; live[i].out = &out[i]; }
+
+    const unsigned T = ThreadPool::resolveThreads(o.threads);
+    const int slice = std::max(1, o.sliceSteps);
+    auto cost = [&](size_t i) { // rough: pair work of the whole run
+        const double n = double(runs_[i].particles.size());
+        return n * n * double(std::max(0, runs_[i].steps));
+    };
+
+    // Large runs: one at a time, each with every thread of its own simulator's pool
+    std::vector<size_t> small;
+    for (size_t i = 0; i < count; ++i) {
+        if (runs_[i].particles.size() <= o.splitAbove) { small.push_back(i); continue; }
+        runs_[i].params.threads = T;
+        out[i].split = true;
+        while (!stepSlice(live[i], slice, o, true)) {}
+    }
+
+    // Small runs: single-threaded, batched, then spread cheapest-first over the
+    // deques so every owner starts on its most expensive batch (back)
+    std::sort(small.begin(), small.end(), [&](size_t a, size_t b) { return cost(a) < cost(b); });
+    std::vector<std::vector<size_t>> batches;
+    size_t inBatch = 0;
+    for (size_t i : small) {
+        runs_[i].params.threads = 1;
+        if (batches.empty() || inBatch >= o.batchParticles) { batches.emplace_back(); inBatch = 0; }
+        batches.back().push_back(i);
+        inBatch += runs_[i].particles.size();
+    }
+
+    std::vector<TaskDeque> deques(T);
+    for (size_t b = 0; b < batches.size(); ++b) deques[b % T].q.push_back(uint32_t(b));
+    std::atomic<size_t> remaining{ batches.size() };
+
+    auto worker = [&](unsigned w) {
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            uint32_t task = 0;
+            bool got = false;
+            {
+                std::lock_guard<std::mutex> lk(deques[w].m);
+                if (!deques[w].q.empty()) { task = deques[w].q.back(); deques[w].q.pop_back(); got = true; }
+            }
+            for (unsigned k = 1; !got && k < T; ++k) { // steal
+                TaskDeque& v = deques[(w + k) % T];
+                std::lock_guard<std::mutex> lk(v.m);
+                if (!v.q.empty()) { task = v.q.front(); v.q.pop_front(); got = true; }
+            }
+            if (!got) { std::this_thread::yield(); continue; }
+
+            // One slice of every unfinished run in the batch
+            const auto& runsIn = batches[task];
+            bool all = true;
+            for (size_t i : runsIn)
+                if (!live[i].finished) all = stepSlice(live[i], slice, o, false) && all;
+            if (all) {
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            } else {
+                std::lock_guard<std::mutex> lk(deques[w].m);
+                deques[w].q.push_back(task);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 1; w < T && w < batches.size(); ++w) threads.emplace_back(worker, w);
+    worker(0);
+    for (auto& t : threads) t.join();
+    return out;
+}
+
+bool Ensemble::writeCsv(const std::string& path, const std::vector<Summary>& s) {
+    std::FILE* f = path.empty() ? stdout : std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "name,n,steps,sim_time,wall_seconds,e0,e1,drift,max_drift,px0,py0,px1,py1,split,final_saved\n");
+    for (const auto& r : s) {
+        std::fprintf(f, "%s,%zu,%d,%.6g,%.6f,%.9g,%.9g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%d,%d\n",
+                     r.name.c_str(), r.n, r.steps, r.simTime, r.wallSeconds, r.e0, r.e1, r.drift,
+                     r.maxDrift, r.px0, r.py0, r.px1, r.py1, int(r.split), int(r.savedFinal));
+    }
+    return f == stdout ? std::fflush(f) == 0 : std::fclose(f) == 0;
+}
@@ -0,0 +1,88 @@
+#include "FieldMap.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 1024 charges (x, y, q: 12 KB) stay in L1 while a tile of samples sweeps them
+constexpr size_t kChargeBlock = 1024;
+// Samples per tile; whole grid rows are handed to the pool
+constexpr size_t kTileSamples = 512;
+}
+
+bool FieldMap::sameGrid(const Config& c) const {
+    return c.cols == cfg_.cols && c.rows == cfg_.rows && c.boundsW == cfg_.boundsW
+        && c.boundsH == cfg_.boundsH && c.k == cfg_.k && c.softening2 == cfg_.softening2
+        && c.isa == cfg_.isa;
+}
+
+bool FieldMap::moved(const float* x, const float* y, const float* q, size_t n, float tol) const {
+    if (n != refX_.size()) return true;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::fabs(x[i] - refX_[i]) > tol || std::fabs(y[i] - refY_[i]) > tol || q[i] != refQ_[i])
+            return true;
+    }
+    return false;
+}
+
+bool FieldMap::update(const Config& c, const float* x, const float* y, const float* q, size_t n,
+                      ThreadPool& pool, bool force) {
+    const bool regrid = !valid_ || !sameGrid(c);
+    ++age_;
+    if (!force && !regrid) {
+        if (age_ < c.minInterval) return false;
+        if (!moved(x, y, q, n, c.moveTolerance)) return false;
+    }
+
+    cfg_ = c;
+    if (regrid) {
+        const size_t cells = size_t(c.cols) * c.rows;
+        px_.resize(cells);
+        py_.resize(cells);
+        const float dx = c.boundsW / float(std::max(1u, c.cols));
+        const float dy = c.boundsH / float(std::max(1u, c.rows));
+        for (unsigned r = 0; r < c.rows; ++r)
+            for (unsigned col = 0; col < c.cols; ++col) {
+                px_[size_t(r) * c.cols + col] = (float(col) + 0.5f) * dx;
+                py_[size_t(r) * c.cols + col] = (float(r) + 0.5f) * dy;
+            }
+        phi_.resize(cells);
+        ex_.resize(cells);
+        ey_.resize(cells);
+    }
+
+    compute(x, y, q, n, pool);
+    refX_.assign(x, x + n);
+    refY_.assign(y, y + n);
+    refQ_.assign(q, q + n);
+    valid_ = true;
+    age_ = 0;
+    ++refreshes_;
+    return true;
+}
+
+void FieldMap::compute(const float* x, const float* y, const float* q, size_t n, ThreadPool& pool) {
+    const size_t cols = cfg_.cols;
+    const size_t rowGrain = std::max<size_t>(1, kTileSamples / std::max<size_t>(1, cols));
+    const kernels::Isa isa = cfg_.isa;
+    const float soft2 = cfg_.softening2, k = cfg_.k;
+
+    pool.parallelFor(cfg_.rows, rowGrain, [&](size_t r0, size_t r1, unsigned) {
+        const size_t s0 = r0 * cols, m = (r1 - r0) * cols;
+        float* phi = phi_.data() + s0;
+        float* ex  = ex_.data() + s0;
+        float* ey  = ey_.data() + s0;
+        std::fill(phi, phi + m, 0.f);
+        std::fill(ex, ex + m, 0.f);
+        std::fill(ey, ey + m, 0.f);
+
+        for (size_t j0 = 0; j0 < n; j0 += kChargeBlock)
+            kernels::fieldAtPoints(isa, x, y, q, j0, std::min(n, j0 + kChargeBlock), soft2,
+                                   px_.data() + s0, py_.data() + s0, m, phi, ex, ey);
+
+        for (size_t s = 0; s < m; ++s) {
+            phi[s] *= k;
+            ex[s]  *= k;
+            ey[s]  *= k;
+        }
+    });
+}
@@ -0,0 +1,510 @@
+#include "ForceKernels.hpp"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ES_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles intrinsics for any ISA without flags; GCC/Clang need the
+// per-function target attribute so the rest of the file stays baseline.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ES_TARGET(isa)
+#else
+#define ES_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace kernels {
+
+namespace {
+
+constexpr size_t kLanes = 8;
+
+// One source j acting on target (xi, yi). Shared by every ISA's tail loop and
+// mirrored op-for-op by the SIMD bodies below. Pot also sums q_j / R into sp
+// (zero separation excluded, which drops the i == j self term).
+template <bool Pot>
+inline void pairTerm(float xi, float yi, float xj, float yj, float qj, float soft2,
+                     float& sx, float& sy, float& sp) {
+    const float rx = xi - xj, ry = yi - yj;
+    const float d2 = rx*rx + ry*ry;
+    const float r2 = d2 + soft2;
+    const float invR = 1.0f / std::sqrt(r2);
+    const float w = r2 > 0.f ? qj * ((invR * invR) * invR) : 0.f;
+    sx += w * rx;
+    sy += w * ry;
+    if constexpr (Pot) sp += d2 > 0.f ? qj * invR : 0.f;
+}
+
+// Sources past the last full block of 8 land in lanes 0..(n-n8-1)
+template <bool Pot>
+inline void tail(float xi, float yi, const float* x, const float* y, const float* q,
+                 size_t n8, size_t n, float soft2, float* sx, float* sy, float* sp) {
+    for (size_t j = n8; j < n; ++j)
+        pairTerm<Pot>(xi, yi, x[j], y[j], q[j], soft2, sx[j - n8], sy[j - n8], sp[j - n8]);
+}
+
+inline float reduce8(const float* s) {
+    return ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+}
+
+inline void finish(size_t i, const float* q, const float* invMass, float k,
+                   const float* sx, const float* sy, float* ax, float* ay) {
+    const float scale = (k * q[i]) * invMass[i];
+    ax[i] = scale * reduce8(sx);
+    ay[i] = scale * reduce8(sy);
+}
+
+template <bool Pot>
+void rowsScalar(const float* x, const float* y, const float* q, const float* invMass,
+                size_t n, float k, float soft2, size_t begin, size_t end,
+                float* ax, float* ay, float* phi) {
+    const size_t n8 = n & ~(kLanes - 1);
+    for (size_t i = begin; i < end; ++i) {
+        const float xi = x[i], yi = y[i];
+        float sx[kLanes] = {}, sy[kLanes] = {}, sp[kLanes] = {};
+        for (size_t j = 0; j < n8; j += kLanes)
+            for (size_t l = 0; l < kLanes; ++l)
+                pairTerm<Pot>(xi, yi, x[j + l], y[j + l], q[j + l], soft2, sx[l], sy[l], sp[l]);
+        tail<Pot>(xi, yi, x, y, q, n8, n, soft2, sx, sy, sp);
+        finish(i, q, invMass, k, sx, sy, ax, ay);
+        if constexpr (Pot) phi[i] = reduce8(sp);
+    }
+}
+
+// Target i against sources [jb, j1), both sides updated
+template <bool Pot>
+inline void pairSpan(size_t i, size_t jb, size_t j1,
+                     const float* x, const float* y, const float* q, float soft2,
+                     float* ex, float* ey, float* phi) {
+    const float xi = x[i], yi = y[i], qi = q[i];
+    float sx = 0.f, sy = 0.f, sp = 0.f;
+    for (size_t j = jb; j < j1; ++j) {
+        const float rx = xi - x[j], ry = yi - y[j];
+        const float d2 = rx*rx + ry*ry;
+        const float r2 = d2 + soft2;
+        const float invR = 1.0f / std::sqrt(r2);
+        const float w = r2 > 0.f ? (invR * invR) * invR : 0.f;
+        sx += q[j] * w * rx;  sy += q[j] * w * ry;
+        ex[j] -= qi * w * rx; ey[j] -= qi * w * ry;
+        if constexpr (Pot) {
+            const float u = d2 > 0.f ? invR : 0.f;
+            sp += q[j] * u;
+            phi[j] += qi * u;
+        }
+    }
+    ex[i] += sx; ey[i] += sy;
+    if constexpr (Pot) phi[i] += sp;
+}
+
+template <bool Pot>
+void tileScalar(const float* x, const float* y, const float* q, float soft2,
+                size_t i0, size_t i1, size_t j0, size_t j1, float* ex, float* ey, float* phi) {
+    const bool same = (i0 == j0);
+    for (size_t i = i0; i < i1; ++i)
+        pairSpan<Pot>(i, same ? i + 1 : j0, j1, x, y, q, soft2, ex, ey, phi);
+}
+
+void fieldScalar(const float* x, const float* y, const float* q, size_t j0, size_t j1, float soft2,
+                 const float* px, const float* py, size_t m, float* phi, float* ex, float* ey) {
+    for (size_t s = 0; s < m; ++s) {
+        const float xs = px[s], ys = py[s];
+        float sp = 0.f, sx = 0.f, sy = 0.f;
+        for (size_t j = j0; j < j1; ++j) {
+            const float rx = xs - x[j], ry = ys - y[j];
+            const float r2 = (rx*rx + ry*ry) + soft2;
+            const float invR = 1.0f / std::sqrt(r2);
+            const float u = r2 > 0.f ? q[j] * invR : 0.f;
+            const float w = u * (invR * invR);
+            sp += u; sx += w * rx; sy += w * ry;
+        }
+        phi[s] += sp; ex[s] += sx; ey[s] += sy;
+    }
+}
+
+// pairTerm with the products widened to double before they are summed
+template <bool Pot>
+inline void pairTermMixed(float xi, float yi, float xj, float yj, float qj, float soft2,
+                          double& sx, double& sy, double& sp) {
+    const float rx = xi - xj, ry = yi - yj;
+    const float d2 = rx*rx + ry*ry;
+    const float r2 = d2 + soft2;
+    const float invR = 1.0f / std::sqrt(r2);
+    const float w = r2 > 0.f ? qj * ((invR * invR) * invR) : 0.f;
+    sx += double(w * rx);
+    sy += double(w * ry);
+    if constexpr (Pot) sp += double(d2 > 0.f ? qj * invR : 0.f);
+}
+
+template <bool Pot>
+inline void tailMixed(float xi, float yi, const float* x, const float* y, const float* q,
+                      size_t n8, size_t n, float soft2, double* sx, double* sy, double* sp) {
+    for (size_t j = n8; j < n; ++j)
+        pairTermMixed<Pot>(xi, yi, x[j], y[j], q[j], soft2, sx[j - n8], sy[j - n8], sp[j - n8]);
+}
+
+inline double reduce8(const double* s) {
+    return ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+}
+
+template <bool Pot>
+inline void finishMixed(size_t i, const float* q, const float* invMass, float k,
+                        const double* sx, const double* sy, const double* sp,
+                        double* ax, double* ay, double* phi) {
+    const double scale = (double(k) * q[i]) * invMass[i];
+    ax[i] = scale * reduce8(sx);
+    ay[i] = scale * reduce8(sy);
+    if constexpr (Pot) phi[i] = reduce8(sp);
+}
+
+template <bool Pot>
+void rowsMixedScalar(const float* x, const float* y, const float* q, const float* invMass,
+                     size_t n, float k, float soft2, size_t begin, size_t end,
+                     double* ax, double* ay, double* phi) {
+    const size_t n8 = n & ~(kLanes - 1);
+    for (size_t i = begin; i < end; ++i) {
+        const float xi = x[i], yi = y[i];
+        double sx[kLanes] = {}, sy[kLanes] = {}, sp[kLanes] = {};
+        for (size_t j = 0; j < n8; j += kLanes)
+            for (size_t l = 0; l < kLanes; ++l)
+                pairTermMixed<Pot>(xi, yi, x[j + l], y[j + l], q[j + l], soft2, sx[l], sy[l], sp[l]);
+        tailMixed<Pot>(xi, yi, x, y, q, n8, n, soft2, sx, sy, sp);
+        finishMixed<Pot>(i, q, invMass, k, sx, sy, sp, ax, ay, phi);
+    }
+}
+
+#if defined(ES_X86)
+
+template <bool Pot>
+ES_TARGET("avx2")
+void tileAVX2(const float* x, const float* y, const float* q, float soft2,
+              size_t i0, size_t i1, size_t j0, size_t j1, float* ex, float* ey, float* phi) {
+    const bool same = (i0 == j0);
+    const __m256 vSoft = _mm256_set1_ps(soft2);
+    const __m256 vOne  = _mm256_set1_ps(1.0f);
+    const __m256 vZero = _mm256_setzero_ps();
+
+    for (size_t i = i0; i < i1; ++i) {
+        const size_t jb = same ? i + 1 : j0;
+        const size_t jv = jb + ((j1 > jb ? j1 - jb : 0) & ~(kLanes - 1));
+        const __m256 xi = _mm256_set1_ps(x[i]), yi = _mm256_set1_ps(y[i]), qi = _mm256_set1_ps(q[i]);
+        __m256 sx = vZero, sy = vZero, sp = vZero;
+
+        for (size_t j = jb; j < jv; j += kLanes) {
+            const __m256 rx = _mm256_sub_ps(xi, _mm256_loadu_ps(x + j));
+            const __m256 ry = _mm256_sub_ps(yi, _mm256_loadu_ps(y + j));
+            const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry));
+            const __m256 r2 = _mm256_add_ps(d2, vSoft);
+            const __m256 invR = _mm256_div_ps(vOne, _mm256_sqrt_ps(r2));
+            __m256 w = _mm256_mul_ps(_mm256_mul_ps(invR, invR), invR);
+            w = _mm256_and_ps(_mm256_cmp_ps(r2, vZero, _CMP_GT_OQ), w);
+            const __m256 wx = _mm256_mul_ps(w, rx), wy = _mm256_mul_ps(w, ry);
+            const __m256 qj = _mm256_loadu_ps(q + j);
+            sx = _mm256_add_ps(sx, _mm256_mul_ps(qj, wx));
+            sy = _mm256_add_ps(sy, _mm256_mul_ps(qj, wy));
+            _mm256_storeu_ps(ex + j, _mm256_sub_ps(_mm256_loadu_ps(ex + j), _mm256_mul_ps(qi, wx)));
+            _mm256_storeu_ps(ey + j, _mm256_sub_ps(_mm256_loadu_ps(ey + j), _mm256_mul_ps(qi, wy)));
+            if constexpr (Pot) {
+                const __m256 u = _mm256_and_ps(_mm256_cmp_ps(d2, vZero, _CMP_GT_OQ), invR);
+                sp = _mm256_add_ps(sp, _mm256_mul_ps(qj, u));
+                _mm256_storeu_ps(phi + j, _mm256_add_ps(_mm256_loadu_ps(phi + j), _mm256_mul_ps(qi, u)));
+            }
+        }
+
+        float lx[kLanes], ly[kLanes];
+        _mm256_storeu_ps(lx, sx);
+        _mm256_storeu_ps(ly, sy);
+        ex[i] += reduce8(lx);
+        ey[i] += reduce8(ly);
+        if constexpr (Pot) {
+            float lp[kLanes];
+            _mm256_storeu_ps(lp, sp);
+            phi[i] += reduce8(lp);
+        }
+        if (jv < j1) pairSpan<Pot>(i, jv, j1, x, y, q, soft2, ex, ey, phi);
+    }
+}
+
+ES_TARGET("avx2")
+void fieldAVX2(const float* x, const float* y, const float* q, size_t j0, size_t j1, float soft2,
+               const float* px, const float* py, size_t m, float* phi, float* ex, float* ey) {
+    const size_t jv = j0 + ((j1 - j0) & ~(kLanes - 1));
+    const __m256 vSoft = _mm256_set1_ps(soft2);
+    const __m256 vOne  = _mm256_set1_ps(1.0f);
+    const __m256 vZero = _mm256_setzero_ps();
+
+    for (size_t s = 0; s < m; ++s) {
+        const __m256 xs = _mm256_set1_ps(px[s]), ys = _mm256_set1_ps(py[s]);
+        __m256 sp = vZero, sx = vZero, sy = vZero;
+
+        for (size_t j = j0; j < jv; j += kLanes) {
+            const __m256 rx = _mm256_sub_ps(xs, _mm256_loadu_ps(x + j));
+            const __m256 ry = _mm256_sub_ps(ys, _mm256_loadu_ps(y + j));
+            const __m256 r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry)), vSoft);
+            const __m256 invR = _mm256_div_ps(vOne, _mm256_sqrt_ps(r2));
+            __m256 u = _mm256_mul_ps(_mm256_loadu_ps(q + j), invR);
+            u = _mm256_and_ps(_mm256_cmp_ps(r2, vZero, _CMP_GT_OQ), u);
+            const __m256 w = _mm256_mul_ps(u, _mm256_mul_ps(invR, invR));
+            sp = _mm256_add_ps(sp, u);
+            sx = _mm256_add_ps(sx, _mm256_mul_ps(w, rx));
+            sy = _mm256_add_ps(sy, _mm256_mul_ps(w, ry));
+        }
+
+        float lp[kLanes], lx[kLanes], ly[kLanes];
+        _mm256_storeu_ps(lp, sp);
+        _mm256_storeu_ps(lx, sx);
+        _mm256_storeu_ps(ly, sy);
+        phi[s] += reduce8(lp);
+        ex[s]  += reduce8(lx);
+        ey[s]  += reduce8(ly);
+    }
+    if (jv < j1) fieldScalar(x, y, q, jv, j1, soft2, px, py, m, phi, ex, ey);
+}
+
+template <bool Pot>
+ES_TARGET("sse2")
+void rowsSSE(const float* x, const float* y, const float* q, const float* invMass,
+             size_t n, float k, float soft2, size_t begin, size_t end,
+             float* ax, float* ay, float* phi) {
+    const size_t n8 = n & ~(kLanes - 1);
+    const __m128 vSoft = _mm_set1_ps(soft2);
+    const __m128 vOne  = _mm_set1_ps(1.0f);
+    const __m128 vZero = _mm_setzero_ps();
+
+    for (size_t i = begin; i < end; ++i) {
+        const __m128 xi = _mm_set1_ps(x[i]), yi = _mm_set1_ps(y[i]);
+        __m128 sx[2] = { vZero, vZero }, sy[2] = { vZero, vZero }, sp[2] = { vZero, vZero };
+
+        for (size_t j = 0; j < n8; j += kLanes) {
+            for (int h = 0; h < 2; ++h) { // lanes 0-3, then 4-7
+                const size_t jj = j + 4 * h;
+                const __m128 rx = _mm_sub_ps(xi, _mm_loadu_ps(x + jj));
+                const __m128 ry = _mm_sub_ps(yi, _mm_loadu_ps(y + jj));
+                const __m128 d2 = _mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry));
+                const __m128 r2 = _mm_add_ps(d2, vSoft);
+                const __m128 invR = _mm_div_ps(vOne, _mm_sqrt_ps(r2));
+                const __m128 qj = _mm_loadu_ps(q + jj);
+                __m128 w = _mm_mul_ps(qj, _mm_mul_ps(_mm_mul_ps(invR, invR), invR));
+                w = _mm_and_ps(_mm_cmpgt_ps(r2, vZero), w);
+                sx[h] = _mm_add_ps(sx[h], _mm_mul_ps(w, rx));
+                sy[h] = _mm_add_ps(sy[h], _mm_mul_ps(w, ry));
+                if constexpr (Pot)
+                    sp[h] = _mm_add_ps(sp[h], _mm_and_ps(_mm_cmpgt_ps(d2, vZero), _mm_mul_ps(qj, invR)));
+            }
+        }
+
+        float lx[kLanes], ly[kLanes], lp[kLanes];
+        _mm_storeu_ps(lx, sx[0]); _mm_storeu_ps(lx + 4, sx[1]);
+        _mm_storeu_ps(ly, sy[0]); _mm_storeu_ps(ly + 4, sy[1]);
+        _mm_storeu_ps(lp, sp[0]); _mm_storeu_ps(lp + 4, sp[1]);
+        tail<Pot>(x[i], y[i], x, y, q, n8, n, soft2, lx, ly, lp);
+        finish(i, q, invMass, k, lx, ly, ax, ay);
+        if constexpr (Pot) phi[i] = reduce8(lp);
+    }
+}
+
+template <bool Pot>
+ES_TARGET("avx2")
+void rowsAVX2(const float* x, const float* y, const float* q, const float* invMass,
+              size_t n, float k, float soft2, size_t begin, size_t end,
+              float* ax, float* ay, float* phi) {
+    const size_t n8 = n & ~(kLanes - 1);
+    const __m256 vSoft = _mm256_set1_ps(soft2);
+    const __m256 vOne  = _mm256_set1_ps(1.0f);
+    const __m256 vZero = _mm256_setzero_ps();
+
+    for (size_t i = begin; i < end; ++i) {
+        const __m256 xi = _mm256_set1_ps(x[i]), yi = _mm256_set1_ps(y[i]);
+        __m256 sx = vZero, sy = vZero, sp = vZero;
+
+        for (size_t j = 0; j < n8; j += kLanes) {
+            const __m256 rx = _mm256_sub_ps(xi, _mm256_loadu_ps(x + j));
+            const __m256 ry = _mm256_sub_ps(yi, _mm256_loadu_ps(y + j));
+            const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry));
+            const __m256 r2 = _mm256_add_ps(d2, vSoft);
+            const __m256 invR = _mm256_div_ps(vOne, _mm256_sqrt_ps(r2));
+            const __m256 qj = _mm256_loadu_ps(q + j);
+            __m256 w = _mm256_mul_ps(qj, _mm256_mul_ps(_mm256_mul_ps(invR, invR), invR));
+            w = _mm256_and_ps(_mm256_cmp_ps(r2, vZero, _CMP_GT_OQ), w);
+            sx = _mm256_add_ps(sx, _mm256_mul_ps(w, rx));
+            sy = _mm256_add_ps(sy, _mm256_mul_ps(w, ry));
+            if constexpr (Pot)
+                sp = _mm256_add_ps(sp, _mm256_and_ps(_mm256_cmp_ps(d2, vZero, _CMP_GT_OQ), _mm256_mul_ps(qj, invR)));
+        }
+
+        float lx[kLanes], ly[kLanes], lp[kLanes];
+        _mm256_storeu_ps(lx, sx);
+        _mm256_storeu_ps(ly, sy);
+        _mm256_storeu_ps(lp, sp);
+        tail<Pot>(x[i], y[i], x, y, q, n8, n, soft2, lx, ly, lp);
+        finish(i, q, invMass, k, lx, ly, ax, ay);
+        if constexpr (Pot) phi[i] = reduce8(lp);
+    }
+}
+
+// Lanes 0-3 and 4-7 of v, widened and added to two double accumulators
+ES_TARGET("avx2")
+inline void widen(__m256d* acc, __m256 v) {
+    acc[0] = _mm256_add_pd(acc[0], _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+    acc[1] = _mm256_add_pd(acc[1], _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+}
+
+// rowsAVX2's float pair terms, summed in double
+template <bool Pot>
+ES_TARGET("avx2")
+void rowsMixedAVX2(const float* x, const float* y, const float* q, const float* invMass,
+                   size_t n, float k, float soft2, size_t begin, size_t end,
+                   double* ax, double* ay, double* phi) {
+    const size_t n8 = n & ~(kLanes - 1);
+    const __m256 vSoft = _mm256_set1_ps(soft2);
+    const __m256 vOne  = _mm256_set1_ps(1.0f);
+    const __m256 vZero = _mm256_setzero_ps();
+
+    for (size_t i = begin; i < end; ++i) {
+        const __m256 xi = _mm256_set1_ps(x[i]), yi = _mm256_set1_ps(y[i]);
+        __m256d sx[2] = { _mm256_setzero_pd(), _mm256_setzero_pd() };
+        __m256d sy[2] = { _mm256_setzero_pd(), _mm256_setzero_pd() };
+        __m256d sp[2] = { _mm256_setzero_pd(), _mm256_setzero_pd() };
+
+        for (size_t j = 0; j < n8; j += kLanes) {
+            const __m256 rx = _mm256_sub_ps(xi, _mm256_loadu_ps(x + j));
+            const __m256 ry = _mm256_sub_ps(yi, _mm256_loadu_ps(y + j));
+            const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry));
+            const __m256 r2 = _mm256_add_ps(d2, vSoft);
+            const __m256 invR = _mm256_div_ps(vOne, _mm256_sqrt_ps(r2));
+            const __m256 qj = _mm256_loadu_ps(q + j);
+            __m256 w = _mm256_mul_ps(qj, _mm256_mul_ps(_mm256_mul_ps(invR, invR), invR));
+            w = _mm256_and_ps(_mm256_cmp_ps(r2, vZero, _CMP_GT_OQ), w);
+            widen(sx, _mm256_mul_ps(w, rx));
+            widen(sy, _mm256_mul_ps(w, ry));
+            if constexpr (Pot)
+                widen(sp, _mm256_and_ps(_mm256_cmp_ps(d2, vZero, _CMP_GT_OQ), _mm256_mul_ps(qj, invR)));
+        }
+
+        double lx[kLanes], ly[kLanes], lp[kLanes];
+        _mm256_storeu_pd(lx, sx[0]); _mm256_storeu_pd(lx + 4, sx[1]);
+        _mm256_storeu_pd(ly, sy[0]); _mm256_storeu_pd(ly + 4, sy[1]);
+        _mm256_storeu_pd(lp, sp[0]); _mm256_storeu_pd(lp + 4, sp[1]);
+        tailMixed<Pot>(x[i], y[i], x, y, q, n8, n, soft2, lx, ly, lp);
+        finishMixed<Pot>(i, q, invMass, k, lx, ly, lp, ax, ay, phi);
+    }
+}
+
+Isa probeIsa() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx     = (info[2] & (1 << 28)) != 0;
+    if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) return Isa::AVX2;
+    }
+    return Isa::SSE; // every x64 CPU has SSE2
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Isa::SSE;
+    return Isa::Scalar;
+#endif
+}
+
+#else
+
+Isa probeIsa() { return Isa::Scalar; }
+
+#endif // ES_X86
+
+} // namespace
+
+Isa detectIsa() {
+    static const Isa best = probeIsa();
+    return best;
+}
+
+Isa resolveIsa(Isa requested) {
+    const Isa best = detectIsa();
+    if (requested == Isa::Auto) return best;
+    // Isa values are ordered Scalar < SSE < AVX2
+    return static_cast<int>(requested) <= static_cast<int>(best) ? requested : best;
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Auto:   return "auto";
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE:    return "sse";
+        case Isa::AVX2:   return "avx2";
+    }
+    return "?";
+}
+
+void coulombRows(Isa isa,
+                 const float* x, const float* y, const float* q, const float* invMass,
+                 size_t n, float k, float soft2,
+                 size_t begin, size_t end,
+                 float* ax, float* ay, float* phi) {
+    const Isa use = resolveIsa(isa);
+    if (phi) {
+        switch (use) {
+#if defined(ES_X86)
+            case Isa::AVX2: rowsAVX2<true>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, phi); return;
+            case Isa::SSE:  rowsSSE <true>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, phi); return;
+#endif
+            default:        rowsScalar<true>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, phi); return;
+        }
+    }
+    switch (use) {
+#if defined(ES_X86)
+        case Isa::AVX2: rowsAVX2<false>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, nullptr); return;
+        case Isa::SSE:  rowsSSE <false>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, nullptr); return;
+#endif
+        default:        rowsScalar<false>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, nullptr); return;
+    }
+}
+
+void coulombPairTile(Isa isa,
+                     const float* x, const float* y, const float* q, float soft2,
+                     size_t i0, size_t i1, size_t j0, size_t j1,
+                     float* ex, float* ey, float* phi) {
+#if defined(ES_X86)
+    if (resolveIsa(isa) == Isa::AVX2) {
+        if (phi) tileAVX2<true>(x, y, q, soft2, i0, i1, j0, j1, ex, ey, phi);
+        else     tileAVX2<false>(x, y, q, soft2, i0, i1, j0, j1, ex, ey, nullptr);
+        return;
+    }
+#endif
+    if (phi) tileScalar<true>(x, y, q, soft2, i0, i1, j0, j1, ex, ey, phi);
+    else     tileScalar<false>(x, y, q, soft2, i0, i1, j0, j1, ex, ey, nullptr);
+}
+
+void coulombRowsMixed(Isa isa,
+                      const float* x, const float* y, const float* q, const float* invMass,
+                      size_t n, float k, float soft2,
+                      size_t begin, size_t end,
+                      double* ax, double* ay, double* phi) {
+#if defined(ES_X86)
+    if (resolveIsa(isa) == Isa::AVX2) {
+        if (phi) rowsMixedAVX2<true>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, phi);
+        else     rowsMixedAVX2<false>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, nullptr);
+        return;
+    }
+#endif
+    if (phi) rowsMixedScalar<true>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, phi);
+    else     rowsMixedScalar<false>(x, y, q, invMass, n, k, soft2, begin, end, ax, ay, nullptr);
+}
+
+void fieldAtPoints(Isa isa,
+                   const float* x, const float* y, const float* q, size_t j0, size_t j1, float soft2,
+                   const float* px, const float* py, size_t m,
+                   float* phi, float* ex, float* ey) {
+#if defined(ES_X86)
+    if (resolveIsa(isa) == Isa::AVX2) { fieldAVX2(x, y, q, j0, j1, soft2, px, py, m, phi, ex, ey); return; }
+#endif
+    fieldScalar(x, y, q, j0, j1, soft2, px, py, m, phi, ex, ey);
+}
+
+} // namespace kernels
@@ -0,0 +1,301 @@
+#include "ParticleMesh.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+static constexpr double kPi = 3.14159265358979323846;
+
+static size_t nextPow2(size_t v) {
+    size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+// ---------------------------------------------------------------- FFT
+
+void ParticleMesh::FFT::init(size_t len) {
+    if (n == len) return;
+    n = len;
+    tw.resize(n / 2);
+    for (size_t k = 0; k < n / 2; ++k) {
+        const double a = -2.0 * kPi * double(k) / double(n);
+        tw[k] = cfloat(float(std::cos(a)), float(std::sin(a)));
+    }
+    rev.resize(n);
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < n) ++bits;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t r = 0;
+        for (unsigned b = 0; b < bits; ++b) if (i & (size_t(1) << b)) r |= 1u << (bits - 1 - b);
+        rev[i] = r;
+    }
+}
+
+// Iterative radix-2, unnormalized. Complex products are written out by hand:
+// operator* on std::complex goes through the slow NaN-checking path.
+void ParticleMesh::FFT::run(cfloat* a, bool inverse) const {
+    for (size_t i = 0; i < n; ++i)
+        if (i < rev[i]) std::swap(a[i], a[rev[i]]);
+
+    const float sign = inverse ? -1.f : 1.f;
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const size_t half = len / 2, stride = n / len;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; ++k) {
+                const float wr = tw[k * stride].real(), wi = sign * tw[k * stride].imag();
+                const cfloat u = a[i + k], v = a[i + k + half];
+                const cfloat t(v.real() * wr - v.imag() * wi, v.real() * wi + v.imag() * wr);
+                a[i + k]        = cfloat(u.real() + t.real(), u.imag() + t.imag());
+                a[i + k + half] = cfloat(u.real() - t.real(), u.imag() - t.imag());
+            }
+        }
+    }
+}
+
+// Rows then columns (forward) or columns then rows (inverse). Only the first
+// `rowsUsed` rows are row-transformed: in free-space mode the padded rows hold
+// no charge going in, and their potential is not needed coming out.
+void ParticleMesh::fft2d(std::vector<cfloat>& a, bool inverse, size_t rowsUsed, ThreadPool& pool) {
+    auto rows = [&] {
+        pool.parallelFor(rowsUsed, 4, [&](size_t b, size_t e, unsigned) {
+            for (size_t j = b; j < e; ++j) fftX_.run(&a[j * Lx_], inverse);
+        });
+    };
+    auto cols = [&] {
+        colScratch_.resize(pool.size());
+        pool.parallelFor(Lx_, 4, [&](size_t b, size_t e, unsigned w) {
+            auto& col = colScratch_[w];
+            col.resize(Ly_);
+            for (size_t i = b; i < e; ++i) {
+                for (size_t j = 0; j < Ly_; ++j) col[j] = a[j * Lx_ + i];
+                fftY_.run(col.data(), inverse);
+                for (size_t j = 0; j < Ly_; ++j) a[j * Lx_ + i] = col[j];
+            }
+        });
+    };
+    if (!inverse) { rows(); cols(); }
+    else          { cols(); rows(); }
+}
+
+// ---------------------------------------------------------------- setup
+
+void ParticleMesh::configure(const Config& c, ThreadPool& pool) {
+    if (configured_ && c.grid == cfg_.grid && c.boundsW == cfg_.boundsW && c.boundsH == cfg_.boundsH
+        && c.soft2 == cfg_.soft2 && c.periodic == cfg_.periodic && c.p3m == cfg_.p3m && c.split == cfg_.split)
+        return;
+    cfg_ = c;
+    configured_ = true;
+
+    n_  = std::max<size_t>(8, nextPow2(c.grid));
+    Lx_ = Ly_ = c.periodic ? n_ : 2 * n_;
+    // Periodic: node n wraps onto node 0. Free space: nodes 0 and n-1 sit on the walls.
+    hx_ = c.boundsW / float(c.periodic ? n_ : n_ - 1);
+    hy_ = c.boundsH / float(c.periodic ? n_ : n_ - 1);
+    const float h = std::max(hx_, hy_);
+    sigma_ = c.split * h;
+
+    fftX_.init(Lx_);
+    fftY_.init(Ly_);
+
+    // Kernel sampled at every node offset (minimum image / zero-padded wrap).
+    // Plain PM cannot resolve below a cell, so its kernel is softened to at
+    // least half a cell; P3M's erf kernel is already smooth there.
+    const float meshSoft2 = c.p3m ? c.soft2 : std::max(c.soft2, 0.25f * h * h);
+    const double twoOverSqrtPi = 2.0 / std::sqrt(kPi);
+    auto offset = [&](size_t i, size_t L) -> double {
+        if (c.periodic) return (i <= L / 2) ? double(i) : double(i) - double(L);
+        return (i < L / 2) ? double(i) : double(i) - double(L);
+    };
+
+    std::vector<cfloat> g(Lx_ * Ly_);
+    for (size_t j = 0; j < Ly_; ++j) {
+        for (size_t i = 0; i < Lx_; ++i) {
+            const double dx = offset(i, Lx_) * hx_, dy = offset(j, Ly_) * hy_;
+            const double R = std::sqrt(dx*dx + dy*dy + meshSoft2);
+            double G;
+            if (c.p3m) G = (R > 0.0) ? std::erf(R / sigma_) / R : twoOverSqrtPi / sigma_;
+            else       G = (R > 0.0) ? 1.0 / R : 0.0;
+            g[j * Lx_ + i] = cfloat(float(G), 0.f);
+        }
+    }
+    fft2d(g, false, Ly_, pool); // the kernel fills the padded rows too
+
+    const float norm = 1.0f / float(Lx_ * Ly_);
+    kernelHat_.resize(Lx_ * Ly_);
+    for (size_t i = 0; i < g.size(); ++i) kernelHat_[i] = g[i].real() * norm; // even kernel -> real spectrum
+}
+
+// ---------------------------------------------------------------- solve
+
+void ParticleMesh::compute(const ParticleStore& s, float k, const Config& c, ThreadPool& pool,
+                           float* ax, float* ay) {
+    configure(c, pool);
+    const size_t N = s.size();
+    const size_t n = n_;
+    const bool periodic = c.periodic;
+    const float invHx = 1.0f / hx_, invHy = 1.0f / hy_;
+
+    // CIC stencil: lower node (i0, j0), upper node (i1, j1), fractional offsets
+    auto stencil = [&](size_t p, size_t& i0, size_t& i1, size_t& j0, size_t& j1, float& fx, float& fy) {
+        float gx = s.x[p] * invHx, gy = s.y[p] * invHy;
+        if (periodic) {
+            gx -= float(n) * std::floor(gx / float(n));
+            gy -= float(n) * std::floor(gy / float(n));
+            i0 = std::min(size_t(gx), n - 1); j0 = std::min(size_t(gy), n - 1);
+            i1 = (i0 + 1) % n;                j1 = (j0 + 1) % n;
+        } else {
+            const float top = float(n - 1) * (1.0f - 1e-6f);
+            gx = std::clamp(gx, 0.f, top);
+            gy = std::clamp(gy, 0.f, top);
+            i0 = size_t(gx); j0 = size_t(gy);
+            i1 = i0 + 1;     j1 = j0 + 1;
+        }
+        fx = gx - float(i0);
+        fy = gy - float(j0);
+    };
+
+    // 1) deposit (serial: O(N), scattered writes)
+    rho_.assign(Lx_ * Ly_, cfloat(0.f, 0.f));
+    for (size_t p = 0; p < N; ++p) {
+        size_t i0, i1, j0, j1; float fx, fy;
+        stencil(p, i0, i1, j0, j1, fx, fy);
+        const float q = s.q[p];
+        rho_[j0 * Lx_ + i0] += q * (1.f - fx) * (1.f - fy);
+        rho_[j0 * Lx_ + i1] += q * fx * (1.f - fy);
+        rho_[j1 * Lx_ + i0] += q * (1.f - fx) * fy;
+        rho_[j1 * Lx_ + i1] += q * fx * fy;
+    }
+
+    // 2) phi = G (*) rho
+    fft2d(rho_, false, n, pool);
+    for (size_t i = 0; i < rho_.size(); ++i) rho_[i] *= kernelHat_[i];
+    fft2d(rho_, true, n, pool);
+
+    // 3) E = -grad phi on the n x n nodes (one-sided at free-space walls)
+    ex_.resize(n * n);
+    ey_.resize(n * n);
+    auto phi = [&](size_t i, size_t j) { return rho_[j * Lx_ + i].real(); };
+    pool.parallelFor(n, 8, [&](size_t b, size_t e, unsigned) {
+        for (size_t j = b; j < e; ++j) {
+            for (size_t i = 0; i < n; ++i) {
+                size_t il, ir, jd, ju; float sx = 0.5f * invHx, sy = 0.5f * invHy;
+                if (periodic) {
+                    il = (i + n - 1) % n; ir = (i + 1) % n;
+                    jd = (j + n - 1) % n; ju = (j + 1) % n;
+                } else {
+                    il = i ? i - 1 : i; ir = (i + 1 < n) ? i + 1 : i;
+                    jd = j ? j - 1 : j; ju = (j + 1 < n) ? j + 1 : j;
+                    if (ir - il == 1) sx = invHx;
+                    if (ju - jd == 1) sy = invHy;
+                }
+                ex_[j * n + i] = -(phi(ir, j) - phi(il, j)) * sx;
+                ey_[j * n + i] = -(phi(i, ju) - phi(i, jd)) * sy;
+            }
+        }
+    });
+
+    // 4) gather with the same CIC weights
+    pool.parallelFor(N, 1024, [&](size_t b, size_t e, unsigned) {
+        for (size_t p = b; p < e; ++p) {
+            size_t i0, i1, j0, j1; float fx, fy;
+            stencil(p, i0, i1, j0, j1, fx, fy);
+            const float w00 = (1.f - fx) * (1.f - fy), w10 = fx * (1.f - fy);
+            const float w01 = (1.f - fx) * fy,         w11 = fx * fy;
+            const float Ex = w00 * ex_[j0 * n + i0] + w10 * ex_[j0 * n + i1] + w01 * ex_[j1 * n + i0] + w11 * ex_[j1 * n + i1];
+            const float Ey = w00 * ey_[j0 * n + i0] + w10 * ey_[j0 * n + i1] + w01 * ey_[j1 * n + i0] + w11 * ey_[j1 * n + i1];
+            const float scale = (k * s.q[p]) * s.invMass[p];
+            ax[p] = scale * Ex;
+            ay[p] = scale * Ey;
+        }
+    });
+
+    // 5) P3M: exact short-range remainder
+    if (c.p3m) shortRange(s, k, pool, ax, ay);
+}
+
+// Short-range part erfc(R/s)/R over neighbours within 3s (erfc(3) ~ 2e-5),
+// found through a uniform cell list at least 3s wide. Each target sums its own
+// neighbours, so the pass is parallel without atomics.
+void ParticleMesh::shortRange(const ParticleStore& s, float k, ThreadPool& pool, float* ax, float* ay) {
+    const size_t N = s.size();
+    const float W = cfg_.boundsW, H = cfg_.boundsH;
+    const bool periodic = cfg_.periodic;
+    const float rc = 3.0f * sigma_;
+    const float rc2 = rc * rc;
+
+    cx_ = std::max<size_t>(1, size_t(W / rc));
+    cy_ = std::max<size_t>(1, size_t(H / rc));
+    cellW_ = W / float(cx_);
+    cellH_ = H / float(cy_);
+    const size_t cells = cx_ * cy_;
+
+    auto cellCoord = [&](float v, float size, size_t count) {
+        float c = v / size;
+        if (periodic) c -= float(count) * std::floor(c / float(count));
+        return std::min(count - 1, size_t(std::max(0.f, c)));
+    };
+
+    // Counting sort of particles into cells
+    cellOf_.resize(N);
+    cellStart_.assign(cells + 1, 0);
+    cellItems_.resize(N);
+    for (size_t p = 0; p < N; ++p) {
+        const size_t c = cellCoord(s.y[p], cellH_, cy_) * cx_ + cellCoord(s.x[p], cellW_, cx_);
+        cellOf_[p] = uint32_t(c);
+        ++cellStart_[c + 1];
+    }
+    for (size_t c = 0; c < cells; ++c) cellStart_[c + 1] += cellStart_[c];
+    // Scatter using cellStart_ as the cursor, then shift it back into place
+    for (size_t p = 0; p < N; ++p) cellItems_[cellStart_[cellOf_[p]]++] = uint32_t(p);
+    for (size_t c = cells; c > 0; --c) cellStart_[c] = cellStart_[c - 1];
+    cellStart_[0] = 0;
+
+    const float sig = sigma_, invSig2 = 1.0f / (sigma_ * sigma_);
+    const float twoOverSigSqrtPi = float(2.0 / (double(sigma_) * std::sqrt(kPi)));
+    const float soft2 = cfg_.soft2;
+
+    pool.parallelFor(N, 256, [&](size_t b, size_t e, unsigned) {
+        for (size_t p = b; p < e; ++p) {
+            const size_t c = cellOf_[p];
+            const long ci = long(c % cx_), cj = long(c / cx_);
+            const float xi = s.x[p], yi = s.y[p];
+            float sx = 0.f, sy = 0.f;
+
+            // Distinct neighbour columns/rows (a 1- or 2-cell periodic axis must not repeat)
+            long cols[3], rows[3]; int nc = 0, nr = 0;
+            for (long d = -1; d <= 1; ++d) {
+                long u = ci + d, v = cj + d;
+                if (periodic) { u = (u + long(cx_)) % long(cx_); v = (v + long(cy_)) % long(cy_); }
+                if (u >= 0 && u < long(cx_) && std::find(cols, cols + nc, u) == cols + nc) cols[nc++] = u;
+                if (v >= 0 && v < long(cy_) && std::find(rows, rows + nr, v) == rows + nr) rows[nr++] = v;
+            }
+
+            for (int a = 0; a < nr; ++a) {
+                for (int bq = 0; bq < nc; ++bq) {
+                    const size_t nb = size_t(rows[a]) * cx_ + size_t(cols[bq]);
+                    for (uint32_t t = cellStart_[nb]; t < cellStart_[nb + 1]; ++t) {
+                        const uint32_t j = cellItems_[t];
+                        if (j == p) continue;
+                        float rx = xi - s.x[j], ry = yi - s.y[j];
+                        if (periodic) { // minimum image
+                            rx -= W * std::round(rx / W);
+                            ry -= H * std::round(ry / H);
+                        }
+                        const float r2 = rx*rx + ry*ry;
+                        if (r2 >= rc2) continue;
+                        const float R2 = r2 + soft2;
+                        if (R2 <= 0.f) continue;
+                        const float R = std::sqrt(R2);
+                        const float t1 = std::erfc(R / sig) / R + twoOverSigSqrtPi * std::exp(-R2 * invSig2);
+                        const float w = s.q[j] * t1 / R2;
+                        sx += w * rx;
+                        sy += w * ry;
+                    }
+                }
+            }
+            const float scale = (k * s.q[p]) * s.invMass[p];
+            ax[p] += scale * sx;
+            ay[p] += scale * sy;
+        }
+    });
+}
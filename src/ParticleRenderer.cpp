@@ -0,0 +1,63 @@
+#include "ParticleRenderer.hpp"
+#include <algorithm>
+#include <cmath>
+
+// White disc with a one-pixel anti-aliased rim; vertex colours tint it
+void ParticleRenderer::ensureTexture() {
+    if (discReady_) return;
+
+    sf::Image img;
+    img.create(kDiscTexSize, kDiscTexSize, sf::Color(255, 255, 255, 0));
+    const float c = 0.5f * kDiscTexSize;
+    const float R = c - 1.0f;
+    for (unsigned py = 0; py < kDiscTexSize; ++py) {
+        for (unsigned px = 0; px < kDiscTexSize; ++px) {
+            const float dx = px + 0.5f - c, dy = py + 0.5f - c;
+            const float cover = std::clamp(R - std::sqrt(dx*dx + dy*dy) + 0.5f, 0.f, 1.f);
+            img.setPixel(px, py, sf::Color(255, 255, 255, static_cast<sf::Uint8>(cover * 255.f)));
+        }
+    }
+    disc_.loadFromImage(img);
+    disc_.setSmooth(true);
+    discReady_ = true;
+}
+
+void ParticleRenderer::draw(sf::RenderTarget& target,
+                            const float* x, const float* y, const float* radius, const Rgba8* color,
+                            size_t n, float ppm) {
+    ensureTexture();
+
+    // Worst case sizes; shrinking afterwards keeps the capacity
+    discs_.resize(6 * n);
+    points_.resize(n);
+    size_t nd = 0, np = 0;
+
+    const float T = static_cast<float>(kDiscTexSize);
+    const sf::Vector2f t00{0.f, 0.f}, t10{T, 0.f}, t11{T, T}, t01{0.f, T};
+
+    for (size_t i = 0; i < n; ++i) {
+        // meters -> pixels
+        const float cx = x[i] * ppm, cy = y[i] * ppm;
+        const float rTrue = radius[i] * ppm;
+        const sf::Color col(color[i].r, color[i].g, color[i].b, color[i].a);
+
+        if (2.f * rTrue < 1.f) {
+            // Sub-pixel at this zoom: a single pixel says as much as a disc
+            points_[np++] = sf::Vertex({ std::floor(cx) + 0.5f, std::floor(cy) + 0.5f }, col);
+            continue;
+        }
+
+        const float r = std::max(minRadiusPx, rTrue); // ensure visible
+        const sf::Vector2f p00{cx - r, cy - r}, p10{cx + r, cy - r}, p11{cx + r, cy + r}, p01{cx - r, cy + r};
+        sf::Vertex* v = &discs_[nd];
+        v[0] = sf::Vertex(p00, col, t00); v[1] = sf::Vertex(p10, col, t10); v[2] = sf::Vertex(p11, col, t11);
+        v[3] = sf::Vertex(p00, col, t00); v[4] = sf::Vertex(p11, col, t11); v[5] = sf::Vertex(p01, col, t01);
+        nd += 6;
+    }
+
+    discs_.resize(nd);
+    points_.resize(np);
+
+    if (nd) target.draw(discs_.data(), nd, sf::Triangles, sf::RenderStates(&disc_));
+    if (np) target.draw(points_.data(), np, sf::Points);
+}
@@ -0,0 +1,127 @@
+#include "PhysicsThread.hpp"
+#include <algorithm>
+#include <chrono>
+
+void Snapshot::capture(const ParticleStore& s, uint64_t stepCount, double time) {
+    // assign() reuses capacity, so steady-state captures are plain copies
+    x.assign(s.x.begin(), s.x.end());
+    y.assign(s.y.begin(), s.y.end());
+    radius.assign(s.radius.begin(), s.radius.end());
+    q.assign(s.q.begin(), s.q.end()); // field overlay
+    color.assign(s.color.begin(), s.color.end());
+    steps = stepCount;
+    simTime = time;
+}
+
+PhysicsThread::PhysicsThread(Simulator& sim, float dt) : sim_(sim), dt_(dt) {}
+
+PhysicsThread::~PhysicsThread() { stop(); }
+
+void PhysicsThread::start() {
+    if (running_.exchange(true)) return;
+    publish(); // readers see the initial scene before the first batch
+    thread_ = std::thread([this] { run(); });
+}
+
+void PhysicsThread::stop() {
+    if (!running_.exchange(false)) return;
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void PhysicsThread::post(Command cmd) {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        pending_.push_back(std::move(cmd));
+    }
+    cv_.notify_one();
+}
+
+void PhysicsThread::setPaused(bool p) {
+    {
+        std::lock_guard<std::mutex> lk(m_); // so a waiting run() cannot miss it
+        paused_.store(p, std::memory_order_relaxed);
+    }
+    cv_.notify_one();
+}
+
+void PhysicsThread::drainCommands() {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        work_.swap(pending_);
+    }
+    for (auto& cmd : work_) cmd(sim_);
+    if (!work_.empty()) publish(); // e.g. spawns while paused must show up
+    work_.clear();
+}
+
+void PhysicsThread::publish() {
+    Snapshot& w = snapshots_.writeBuffer();
+    w.capture(sim_.store(), steps_, simTime_);
+    w.diag = sim_.diagnostics();
+    w.k = sim_.params().k;
+    w.softening2 = sim_.params().softening2;
+    w.boundsW = sim_.params().boundsW;
+    w.boundsH = sim_.params().boundsH;
+    w.bz = sim_.params().bz;
+    snapshots_.publish();
+}
+
+void PhysicsThread::run() {
+    using clock = std::chrono::steady_clock;
+    auto last = clock::now();
+    auto rateStart = last;
+    uint64_t rateSteps = steps_;
+    float accTime = 0.0f;
+
+    // Sleep up to `s` seconds, waking early for commands, pause changes or stop()
+    auto waitFor = [&](float s) {
+        std::unique_lock<std::mutex> lk(m_);
+        const bool wasPaused = paused_.load(std::memory_order_relaxed);
+        cv_.wait_for(lk, std::chrono::duration<float>(s), [&] {
+            return !running_.load() || !pending_.empty()
+                || paused_.load(std::memory_order_relaxed) != wasPaused;
+        });
+    };
+
+    while (running_.load()) {
+        drainCommands();
+
+        const auto now = clock::now();
+        const float frame = std::chrono::duration<float>(now - last).count();
+        last = now;
+
+        if (paused_.load(std::memory_order_relaxed)) {
+            accTime = 0.0f; // do NOT accumulate time while paused
+            stepsPerSec_.store(0.f, std::memory_order_relaxed);
+            rateStart = now; rateSteps = steps_;
+            waitFor(0.01f);
+            continue;
+        }
+
+        accTime += std::min(frame, maxCatchUp);
+        const int steps = std::min(static_cast<int>(accTime / dt_), maxStepsPerBatch);
+        if (steps > 0) {
+            if (recorder_) recorder_->advance(sim_, dt_, steps);
+            else           sim_.advance(dt_, steps);
+            steps_   += static_cast<uint64_t>(steps);
+            simTime_ += double(steps) * dt_;
+            accTime  -= steps * dt_;
+            if (steps == maxStepsPerBatch) { // drop leftover time
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + accTime, std::memory_order_relaxed);
+                accTime = 0.0f;
+            }
+            publish();
+        }
+
+        const float rateWindow = std::chrono::duration<float>(now - rateStart).count();
+        if (rateWindow >= 1.0f) {
+            stepsPerSec_.store(float(steps_ - rateSteps) / rateWindow, std::memory_order_relaxed);
+            rateStart = now; rateSteps = steps_;
+        }
+
+        // Sleep until the next step is due
+        const float untilNext = dt_ - accTime;
+        if (untilNext > 0.f) waitFor(untilNext);
+    }
+}
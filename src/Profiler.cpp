@@ -0,0 +1,130 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace prof {
+
+const char* phaseName(Phase p) {
+    switch (p) {
+        case Phase::Forces:    return "forces";
+        case Phase::Integrate: return "integrate";
+        case Phase::Contacts:  return "contacts";
+        case Phase::Bounds:    return "bounds";
+        case Phase::Events:    return "events";
+        case Phase::Update:    return "update";
+        case Phase::Field:     return "field";
+        case Phase::Draw:      return "draw";
+        case Phase::Display:   return "display";
+        case Phase::Frame:     return "frame";
+        case Phase::Count:     break;
+    }
+    return "?";
+}
+
+const char* counterName(Counter c) {
+    switch (c) {
+        case Counter::StepsPerFrame: return "steps_per_frame";
+        case Counter::DroppedTime:   return "dropped_time_s";
+        case Counter::Particles:     return "particles";
+        case Counter::Count:         break;
+    }
+    return "?";
+}
+
+uint32_t threadIndex() {
+    static std::atomic<uint32_t> next{0};
+    thread_local const uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+Profiler::Profiler() : epoch_(now()) {
+    if constexpr (kEnabled) tracks_ = std::make_unique<Ring[]>(kTracks);
+}
+
+template <class F>
+void Profiler::forEach(size_t track, F&& fn) const {
+    if (!tracks_) return;
+    const Ring& r = tracks_[track];
+    const uint64_t head = r.head.load(std::memory_order_acquire);
+    const uint64_t first = head > kRing ? head - kRing : 0;
+    for (uint64_t i = first; i < head; ++i) {
+        const Slot& s = r.slot[i % kRing];
+        fn(s.t.load(std::memory_order_relaxed), s.v.load(std::memory_order_relaxed),
+           s.tid.load(std::memory_order_relaxed));
+    }
+}
+
+static double asDouble(uint64_t bits) {
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+Profiler::Stats Profiler::stats(Phase p) const {
+    std::vector<uint64_t> d;
+    d.reserve(kRing);
+    forEach(size_t(p), [&](uint64_t, uint64_t v, uint32_t) { d.push_back(v); });
+    Stats st;
+    if (d.empty()) return st;
+
+    uint64_t sum = 0;
+    for (uint64_t v : d) sum += v;
+    const size_t k99 = (d.size() * 99) / 100; // nearest-rank p99
+    std::nth_element(d.begin(), d.begin() + std::min(k99, d.size() - 1), d.end());
+    st.p99Ms   = double(d[std::min(k99, d.size() - 1)]) * 1e-6;
+    st.minMs   = double(*std::min_element(d.begin(), d.end())) * 1e-6;
+    st.meanMs  = double(sum) / double(d.size()) * 1e-6;
+    st.samples = d.size();
+    return st;
+}
+
+double Profiler::latest(Counter c) const {
+    double v = 0.0;
+    forEach(size_t(Phase::Count) + size_t(c), [&](uint64_t, uint64_t bits, uint32_t) { v = asDouble(bits); });
+    return v;
+}
+
+bool Profiler::writeCsv(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "kind,name,thread,start_us,value\n");
+    for (size_t p = 0; p < size_t(Phase::Count); ++p) {
+        forEach(p, [&](uint64_t t, uint64_t v, uint32_t tid) {
+            std::fprintf(f, "phase,%s,%u,%.3f,%.3f\n", phaseName(Phase(p)), tid,
+                         double(t - epoch_) * 1e-3, double(v) * 1e-3);
+        });
+    }
+    for (size_t c = 0; c < size_t(Counter::Count); ++c) {
+        forEach(size_t(Phase::Count) + c, [&](uint64_t t, uint64_t v, uint32_t tid) {
+            std::fprintf(f, "counter,%s,%u,%.3f,%.9g\n", counterName(Counter(c)), tid,
+                         double(t - epoch_) * 1e-3, asDouble(v));
+        });
+    }
+    return std::fclose(f) == 0;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    const char* sep = "";
+    for (size_t p = 0; p < size_t(Phase::Count); ++p) {
+        forEach(p, [&](uint64_t t, uint64_t v, uint32_t tid) {
+            std::fprintf(f, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                         sep, phaseName(Phase(p)), tid, double(t - epoch_) * 1e-3, double(v) * 1e-3);
+            sep = ",\n";
+        });
+    }
+    for (size_t c = 0; c < size_t(Counter::Count); ++c) {
+        forEach(size_t(Phase::Count) + c, [&](uint64_t t, uint64_t v, uint32_t) {
+            std::fprintf(f, "%s{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"ts\": %.3f, \"args\": {\"value\": %.9g}}",
+                         sep, counterName(Counter(c)), double(t - epoch_) * 1e-3, asDouble(v));
+            sep = ",\n";
+        });
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
+
+} // namespace prof
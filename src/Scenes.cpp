@@ -0,0 +1,62 @@
+#include "Scenes.hpp"
+
+namespace scenes {
+
+static const Rgba8 kPositive{ 255, 0, 0, 255 }; // red
+static const Rgba8 kNegative{ 0, 0, 255, 255 }; // blue
+
+static Particle make(float x, float y, float vx, float vy, float q, const Body& b) {
+    return { { x, y }, { vx, vy }, q, b.mass, b.radius, q >= 0.f ? kPositive : kNegative };
+}
+
+// Evenly spaced sample i of n over [a, a + len] (midpoint for n = 1)
+static float spread(size_t i, size_t n, float a, float len) {
+    return n > 1 ? a + len * float(i) / float(n - 1) : a + 0.5f * len;
+}
+
+std::vector<Particle> lattice(size_t nx, size_t ny, float x0, float y0, float w, float h,
+                              const Body& b, bool alternate) {
+    std::vector<Particle> out;
+    out.reserve(nx * ny);
+    for (size_t j = 0; j < ny; ++j) {
+        const float y = spread(j, ny, y0, h);
+        for (size_t i = 0; i < nx; ++i) {
+            const float q = (alternate && ((i + j) & 1)) ? -b.charge : b.charge;
+            out.push_back(make(spread(i, nx, x0, w), y, 0.f, 0.f, q, b));
+        }
+    }
+    return out;
+}
+
+// xorshift32 -> [0, 1). Much cheaper than <random> distributions per particle,
+// and plenty for initial conditions.
+static inline float unit(uint32_t& s) {
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return float(s >> 8) * (1.0f / 16777216.0f);
+}
+
+std::vector<Particle> randomGas(size_t n, float w, float h, float speed, const Body& b, uint32_t seed) {
+    std::vector<Particle> out;
+    out.reserve(n);
+    uint32_t s = seed ? seed : 1u;
+    for (size_t i = 0; i < n; ++i) {
+        const float x  = unit(s) * w, y = unit(s) * h;
+        const float vx = (2.f * unit(s) - 1.f) * speed;
+        const float vy = (2.f * unit(s) - 1.f) * speed;
+        out.push_back(make(x, y, vx, vy, (i & 1) ? -b.charge : b.charge, b));
+    }
+    return out;
+}
+
+std::vector<Particle> dipoleSheets(size_t perSheet, float cx, float gap, float y0, float h, const Body& b) {
+    std::vector<Particle> out;
+    out.reserve(2 * perSheet);
+    for (size_t i = 0; i < perSheet; ++i) {
+        const float y = spread(i, perSheet, y0, h);
+        out.push_back(make(cx - 0.5f * gap, y, 0.f, 0.f, +b.charge, b));
+        out.push_back(make(cx + 0.5f * gap, y, 0.f, 0.f, -b.charge, b));
+    }
+    return out;
+}
+
+} // namespace scenes
@@ -2,83 +2,563 @@
 #include <SFML/System/Vector2.hpp> // sf::Vector2f
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <type_traits>
 
-static inline sf::Vector2f clampMag(const sf::Vector2f& v, float maxMag) {
-    float m2 = v.x*v.x + v.y*v.y;
-    if (m2 <= maxMag*maxMag) return v;
+// true when the vector had to be shortened
+static inline bool clampMag(float& ax, float& ay, float maxMag) {
+    float m2 = ax*ax + ay*ay;
+    if (m2 <= maxMag*maxMag) return false;
     float inv = maxMag / std::sqrt(m2);
-    return {v.x * inv, v.y * inv};
+    ax *= inv; ay *= inv;
+    return true;
 }
 
 Simulator::Simulator(const Params& p) : P(p) {}
 
-void Simulator::clear() { particles_.clear(); }
+ThreadPool& Simulator::pool() {
+    const unsigned want = ThreadPool::resolveThreads(P.threads);
+    if (!pool_ || pool_->size() != want) pool_ = std::make_unique<ThreadPool>(want);
+    return *pool_;
+}
+
+void Simulator::clear() { store_.clear(); particlesReplaced(); }
+
+void Simulator::addParticle(const Particle& p) {
+    store_.push(p);
+    level_.resize(store_.size(), kNoLevel);
+    viewDirty_ = true;
+}
 
-void Simulator::addParticle(const Particle& p) { particles_.push_back(p); }
+void Simulator::addParticles(std::span<const Particle> ps) {
+    store_.append(ps.data(), ps.size());
+    level_.resize(store_.size(), kNoLevel);
+    viewDirty_ = true;
+}
+
+void Simulator::setParticle(size_t i, const Particle& p) {
+    store_.set(i, p);
+    if (i < level_.size()) level_[i] = kNoLevel; // its old step no longer applies
+    viewDirty_ = true;
+}
+
+// A new set of particles: nobody inherits a block level or double state from
+// whoever held its index
+void Simulator::particlesReplaced() {
+    level_.assign(store_.size(), kNoLevel);
+    for (auto* col : { &xd_, &yd_, &vxd_, &vyd_ }) col->clear();
+    viewDirty_ = true;
+}
+
+const std::vector<Particle>& Simulator::particles() const {
+    if (viewDirty_ || view_.size() != store_.size()) {
+        view_.resize(store_.size());
+        for (size_t i = 0; i < store_.size(); ++i) view_[i] = store_.get(i);
+        viewDirty_ = false;
+    }
+    return view_;
+}
 
 // O(N^2) Coulomb forces with softening; no particle collisions.
-void Simulator::computeForcesNaive(std::vector<sf::Vector2f>& acc) const {
-    const size_t n = particles_.size();
-    std::fill(acc.begin(), acc.end(), sf::Vector2f{0.f, 0.f});
+// Each row i sums over all j, so no scatter to acc[j] and no per-pair mass divide.
+void Simulator::computeForcesNaive(std::vector<float>& ax, std::vector<float>& ay) {
+    const size_t n = store_.size();
+    std::fill(ax.begin(), ax.end(), 0.f);
+    std::fill(ay.begin(), ay.end(), 0.f);
 
     if (!electroOn_ || n==0) return;
+    if (!P.deterministic) { computeForcesSymmetric(ax, ay); return; }
 
+    // Rows are independent, so any split reproduces the serial result bit-for-bit
+    const auto& S = store_;
+    float* phi = potentialOut();
+    pool().parallelFor(n, kRowGrain, [&](size_t b, size_t e, unsigned) {
+        kernels::coulombRows(P.isa, S.x.data(), S.y.data(), S.q.data(), S.invMass.data(),
+                             n, P.k, P.softening2, b, e, ax.data(), ay.data(), phi);
+    });
+    phiValid_ = phi != nullptr;
+}
+
+// Symmetric pairs without atomics: split the particles into B (odd) blocks and
+// run B rounds. In round r block I meets block J = (r - I) mod B, so each block
+// is touched by exactly one task per round and every block pair (including the
+// block with itself) comes up exactly once.
+void Simulator::computeForcesSymmetric(std::vector<float>& ax, std::vector<float>& ay) {
+    const size_t n = store_.size();
+    const auto& S = store_;
+    ThreadPool& tp = pool();
+
+    size_t B = 4 * size_t(tp.size()) + 1;
+    if (n < 2048 || tp.size() == 1) B = 1;
+    const size_t bs = (n + B - 1) / B;
+    const size_t half = (B + 1) / 2;              // inverse of 2 mod B
+    auto lo = [&](size_t I) { return std::min(I * bs, n); };
+    float* phi = potentialOut();
+    if (phi) std::fill(phi, phi + n, 0.f);
+
+    for (size_t r = 0; r < B; ++r) {
+        const size_t self = (r * half) % B;       // 2*self == r (mod B)
+        tp.parallelFor(half, 1, [&](size_t b, size_t e, unsigned) {
+            for (size_t d = b; d < e; ++d) {
+                const size_t I = (self + B - d) % B, J = (self + d) % B;
+                kernels::coulombPairTile(P.isa, S.x.data(), S.y.data(), S.q.data(), P.softening2,
+                                         lo(I), lo(I + 1), lo(J), lo(J + 1), ax.data(), ay.data(), phi);
+            }
+        });
+    }
+
+    // Field -> acceleration
+    tp.parallelFor(n, kLoopGrain, [&](size_t b, size_t e, unsigned) {
+        for (size_t i = b; i < e; ++i) {
+            const float s = (P.k * S.q[i]) * S.invMass[i];
+            ax[i] *= s; ay[i] *= s;
+        }
+    });
+    phiValid_ = phi != nullptr;
+}
+
+// The original AoS loop, kept as the reference the SIMD kernels are checked against.
+void Simulator::computeForcesReference(std::vector<float>& ax, std::vector<float>& ay) const {
+    const size_t n = store_.size();
+    std::fill(ax.begin(), ax.end(), 0.f);
+    std::fill(ay.begin(), ay.end(), 0.f);
+
+    if (!electroOn_ || n==0) return;
+
+    const auto& S = store_;
     for (size_t i=0; i<n; ++i){
         for(size_t j=i+1; j<n; ++j){
-            const auto rij = particles_[i].pos - particles_[j].pos; // meters
-            float r2 = rij.x*rij.x + rij.y*rij.y + P.softening2;    // m^2 + ε^2
+            const float rx = S.x[i] - S.x[j], ry = S.y[i] - S.y[j]; // meters
+            float r2 = rx*rx + ry*ry + P.softening2;                 // m^2 + ε^2
             float invR  = 1.0f / std::sqrt(r2);
             float invR3 = invR * invR * invR;
-            
+
             // Coulomb force magnitude scaled into vector form (N/m * m = N)
-            const float s = P.k * (particles_[i].charge * particles_[j].charge) * invR3;
-            sf::Vector2f f = { s * rij.x, s * rij.y }; // Newtons
+            const float s = P.k * (S.q[i] * S.q[j]) * invR3;
+            const float fx = s * rx, fy = s * ry; // Newtons
 
             // Accelerations (m/s^2)
-            sf::Vector2f ai = { f.x / particles_[i].mass, f.y / particles_[i].mass };
-            sf::Vector2f aj = { -f.x / particles_[j].mass, -f.y / particles_[j].mass };
+            ax[i] += fx / S.mass[i];  ay[i] += fy / S.mass[i];
+            ax[j] -= fx / S.mass[j];  ay[j] -= fy / S.mass[j];
+        }
+    }
+}
+
+// Barnes–Hut: one tree build, then an independent traversal per particle.
+void Simulator::computeForcesBarnesHut(std::vector<float>& ax, std::vector<float>& ay) {
+    const size_t n = store_.size();
+    std::fill(ax.begin(), ax.end(), 0.f);
+    std::fill(ay.begin(), ay.end(), 0.f);
+
+    if (!electroOn_ || n==0) return;
 
-            acc[i] += ai;
-            acc[j] += aj;
+    tree_.build(store_.x.data(), store_.y.data(), store_.q.data(), n, P.boundsW, P.boundsH);
+    float* phi = potentialOut();
+    pool().parallelFor(n, kRowGrain * 4, [&](size_t b, size_t end, unsigned) {
+        for (size_t slot = b; slot < end; ++slot) {
+            const size_t i = tree_.particleAt(slot); // Morton order
+            const sf::Vector2f e = phi ? tree_.field(i, P.theta, P.softening2, phi[i])
+                                       : tree_.field(i, P.theta, P.softening2);
+            const float s = P.k * store_.q[i] * store_.invMass[i];
+            ax[i] = s * e.x; // m/s^2
+            ay[i] = s * e.y;
         }
+    });
+    phiValid_ = phi != nullptr;
+}
+
+// Particle mesh over the world rectangle; periodic when the walls wrap.
+void Simulator::computeForcesParticleMesh(std::vector<float>& ax, std::vector<float>& ay) {
+    const size_t n = store_.size();
+    if (!electroOn_ || n==0) {
+        std::fill(ax.begin(), ax.end(), 0.f);
+        std::fill(ay.begin(), ay.end(), 0.f);
+        return;
+    }
+
+    ParticleMesh::Config c;
+    c.grid = P.pmGrid;
+    c.boundsW = P.boundsW;
+    c.boundsH = P.boundsH;
+    c.soft2 = P.softening2;
+    c.periodic = boundsOn_ && P.boundary == Boundary::Periodic;
+    c.p3m = P.p3m;
+    c.split = P.p3mSplit;
+    pm_.compute(store_, P.k, c, pool(), ax.data(), ay.data());
+}
+
+void Simulator::computeForcesUnclamped(std::vector<float>& ax, std::vector<float>& ay) {
+    switch (P.solver) {
+        case Solver::BarnesHut:    computeForcesBarnesHut(ax, ay);    break;
+        case Solver::ParticleMesh: computeForcesParticleMesh(ax, ay); break;
+        case Solver::Naive:
+        default:                   computeForcesNaive(ax, ay);        break;
     }
-    for (auto& a : acc) a = clampMag(a, P.maxAccel); // numerical safety
 }
 
-// Symplectic Euler: v_{t+dt} = v_t + a_t dt ; x_{t+dt} = x_t + v_{t+dt} dt
-void Simulator::integrateSymplecticEuler(float dt, std::vector<sf::Vector2f>& acc) {
-    const size_t n = particles_.size();
+void Simulator::computeForces(std::vector<float>& ax, std::vector<float>& ay) {
+    phiValid_ = false;
+    computeForcesUnclamped(ax, ay);
+    if (!diagOn_) {
+        pool().parallelFor(store_.size(), kLoopGrain, [&](size_t b, size_t e, unsigned) {
+            for (size_t i = b; i < e; ++i) clampMag(ax[i], ay[i], P.maxAccel); // numerical safety
+        });
+        return;
+    }
+    pool().parallelFor(store_.size(), kLoopGrain, [&](size_t b, size_t e, unsigned w) {
+        uint32_t hits = 0;
+        for (size_t i = b; i < e; ++i) hits += clampMag(ax[i], ay[i], P.maxAccel);
+        diagPart_[w].clampHits += hits;
+    });
+}
+
+Simulator::ForceError Simulator::measureForceError(size_t maxSamples) {
+    ForceError err;
+    const size_t n = store_.size();
+    if (!electroOn_ || n == 0 || maxSamples == 0) return err;
+
+    std::vector<float> ax(n), ay(n), ex(n), ey(n);
+    computeForcesUnclamped(ax, ay);
+
+    // Accumulate in double: the sums span many orders of magnitude
+    double num = 0.0, den = 0.0;
+    const size_t stride = (n + maxSamples - 1) / maxSamples; // at most maxSamples rows
+    for (size_t i = 0; i < n; i += stride) {
+        kernels::coulombRows(P.isa, store_.x.data(), store_.y.data(), store_.q.data(), store_.invMass.data(),
+                             n, P.k, P.softening2, i, i + 1, ex.data(), ey.data());
+        const double dx = ax[i] - ex[i], dy = ay[i] - ey[i];
+        const double e2 = dx*dx + dy*dy;
+        const double a2 = double(ex[i])*ex[i] + double(ey[i])*ey[i];
+        num += e2; den += a2;
+        if (a2 > 0.0) err.maxRel = std::max(err.maxRel, float(std::sqrt(e2 / a2)));
+        ++err.samples;
+    }
+    if (den > 0.0) err.rmsRel = float(std::sqrt(num / den));
+    return err;
+}
+
+Simulator::KernelCheck Simulator::verifyKernels() const {
+    KernelCheck chk;
+    const size_t n = store_.size();
+    if (n == 0) return chk;
+
+    auto run = [&](kernels::Isa isa, std::vector<float>& ax, std::vector<float>& ay) {
+        ax.assign(n, 0.f); ay.assign(n, 0.f);
+        kernels::coulombRows(isa, store_.x.data(), store_.y.data(), store_.q.data(), store_.invMass.data(),
+                             n, P.k, P.softening2, 0, n, ax.data(), ay.data());
+    };
+
+    std::vector<float> sx, sy, vx, vy;
+    run(kernels::Isa::Scalar, sx, sy);
+    for (auto isa : { kernels::Isa::SSE, kernels::Isa::AVX2 }) {
+        if (kernels::resolveIsa(isa) != isa) continue; // not supported here
+        run(isa, vx, vy);
+        chk.bitExact = chk.bitExact
+            && std::memcmp(sx.data(), vx.data(), n * sizeof(float)) == 0
+            && std::memcmp(sy.data(), vy.data(), n * sizeof(float)) == 0;
+    }
+
+    std::vector<float> rx(n), ry(n);
+    computeForcesReference(rx, ry);
     for (size_t i = 0; i < n; ++i) {
-        particles_[i].vel += acc[i] * dt;            // m/s
-        particles_[i].pos += particles_[i].vel * dt; // m
+        const float dx = sx[i] - rx[i], dy = sy[i] - ry[i];
+        const float a2 = rx[i]*rx[i] + ry[i]*ry[i];
+        if (a2 > 0.f) chk.maxRelVsReference = std::max(chk.maxRelVsReference, std::sqrt((dx*dx + dy*dy) / a2));
     }
+    return chk;
 }
 
-// Reflect from rectangular bounds (meters)
+// Reflect from (or wrap around) rectangular bounds (meters)
 void Simulator::applyBounds() {
-    for (auto& p : particles_) {
-        // Left/Right
-        if (p.pos.x < p.radius) {
-            p.pos.x = p.radius;
-            p.vel.x = -p.vel.x * P.restitution;
-        } else if (p.pos.x > P.boundsW - p.radius) {
-            p.pos.x = P.boundsW - p.radius;
-            p.vel.x = -p.vel.x * P.restitution;
+    auto& S = store_;
+    if (P.boundary == Boundary::Periodic) {
+        const float W = P.boundsW, H = P.boundsH;
+        pool().parallelFor(S.size(), kLoopGrain, [&](size_t b, size_t e, unsigned) {
+            for (size_t i = b; i < e; ++i) {
+                S.x[i] -= W * std::floor(S.x[i] / W);
+                S.y[i] -= H * std::floor(S.y[i] / H);
+            }
+        });
+        return;
+    }
+    pool().parallelFor(S.size(), kLoopGrain, [&](size_t b, size_t e, unsigned) {
+        for (size_t i = b; i < e; ++i) {
+            const float r = S.radius[i];
+            // Left/Right
+            if (S.x[i] < r) {
+                S.x[i] = r;
+                S.vx[i] = -S.vx[i] * P.restitution;
+            } else if (S.x[i] > P.boundsW - r) {
+                S.x[i] = P.boundsW - r;
+                S.vx[i] = -S.vx[i] * P.restitution;
+            }
+            // Top/Bottom
+            if (S.y[i] < r) {
+                S.y[i] = r;
+                S.vy[i] = -S.vy[i] * P.restitution;
+            } else if (S.y[i] > P.boundsH - r) {
+                S.y[i] = P.boundsH - r;
+                S.vy[i] = -S.vy[i] * P.restitution;
+            }
         }
-        // Top/Bottom
-        if (p.pos.y < p.radius) {
-            p.pos.y = p.radius;
-            p.vel.y = -p.vel.y * P.restitution;
-        } else if (p.pos.y > P.boundsH - p.radius) {
-            p.pos.y = P.boundsH - p.radius;
-            p.vel.y = -p.vel.y * P.restitution;
+    });
+}
+
+void Simulator::clampToBounds() {
+    const size_t n = store_.size();
+    auto& S = store_;
+    for (size_t i = 0; i < n; ++i) {
+        const float r = S.radius[i];
+        S.x[i] = std::min(std::max(S.x[i], r), P.boundsW - r);
+        S.y[i] = std::min(std::max(S.y[i], r), P.boundsH - r);
+    }
+    viewDirty_ = true;
+}
+
+void Simulator::step(float dt) { advance(dt, 1); }
+
+void Simulator::advance(float dt, int nSteps) {
+    if (nSteps <= 0) return;
+
+    // One-time setup for the whole batch
+    const size_t n = store_.size();
+    ax_.resize(n);
+    ay_.resize(n);
+    pool();
+    if (diagOn_) {
+        phi_.resize(n);
+        diagPart_.resize(pool_->size());
+    }
+
+    if (P.integrator != Integrator::BlockTimestep) {
+        advancePrecise(dt, nSteps); // SimulatorPrecise.cpp
+        viewDirty_ = true;
+        return;
+    }
+
+    for (int s = 0; s < nSteps; ++s) {
+        if (diagOn_) beginDiagnostics();
+        advanceBlock(dt);
+        if (diagOn_) {
+            // Velocities only settle once per dt here, so K and p take
+            // their own pass instead of riding on the kicks
+            const auto& S = store_;
+            pool().parallelFor(n, kLoopGrain, [&](size_t b, size_t e, unsigned w) {
+                double ke = 0.0, px = 0.0, py = 0.0;
+                for (size_t i = b; i < e; ++i) {
+                    const double mi = S.mass[i], vx = S.vx[i], vy = S.vy[i];
+                    ke += 0.5 * mi * (vx * vx + vy * vy);
+                    px += mi * vx;
+                    py += mi * vy;
+                }
+                diagPart_[w].kinetic += ke; diagPart_[w].px += px; diagPart_[w].py += py;
+            });
+            diagClock_ += dt;
+            endDiagnostics(diagClock_, false);
         }
     }
+    viewDirty_ = true;
 }
 
-void Simulator::step(float dt) {
-    std::vector<sf::Vector2f> acc(particles_.size());
-    computeForcesNaive(acc);
-    integrateSymplecticEuler(dt, acc);
-    if (boundsOn_) applyBounds();
-}
\ No newline at end of file
+void Simulator::setDiagnosticsEnabled(bool on) {
+    if (on && !diagOn_) clearDiagnostics();
+    diagOn_ = on;
+    phiValid_ = false;
+}
+
+void Simulator::clearDiagnostics() {
+    diag_ = StepDiagnostics{};
+    diagHist_.clear();
+    diagClock_ = 0.0;
+}
+
+float* Simulator::potentialOut() {
+    return (diagOn_ && phi_.size() == store_.size()) ? phi_.data() : nullptr;
+}
+
+void Simulator::beginDiagnostics() {
+    std::fill(diagPart_.begin(), diagPart_.end(), DiagPartial{});
+}
+
+// Shared-dt steps are stamped with their force time t (K and U both refer to
+// x_t); block steps with the end of the dt, where their velocities are read.
+void Simulator::endDiagnostics(double time, bool potential) {
+    DiagPartial sum;
+    for (const auto& d : diagPart_) {
+        sum.kinetic += d.kinetic; sum.qphi += d.qphi;
+        sum.px += d.px; sum.py += d.py;
+        sum.clampHits += d.clampHits;
+    }
+    StepDiagnostics d;
+    d.step = diag_.step + 1;
+    d.time = time;
+    d.kinetic = sum.kinetic;
+    d.potential = potential ? 0.5 * double(P.k) * sum.qphi : 0.0;
+    d.hasPotential = potential;
+    d.px = sum.px;
+    d.py = sum.py;
+    d.clampHits = sum.clampHits;
+    diag_ = d;
+    diagHist_.push(d);
+}
+
+void Simulator::applyContactsAndBounds() {
+    if (collisionsOn_) {
+        prof::Scope t(prof_, prof::Phase::Contacts);
+        collide_.findContacts(store_, pool());
+        collide_.resolve(store_, P.restitution);
+    }
+    if (boundsOn_) {
+        prof::Scope t(prof_, prof::Phase::Bounds);
+        applyBounds();
+    }
+}
+
+// Forces for the particles in active_ only. Naive and Barnes–Hut evaluate just
+// those rows; the mesh solver has no per-particle shortcut and fills everyone.
+void Simulator::computeForcesActive() {
+    const size_t n = store_.size();
+    const size_t m = active_.size();
+    const auto& S = store_;
+    bax_.resize(n);
+    bay_.resize(n);
+
+    if (!electroOn_ || n == 0) {
+        for (uint32_t i : active_) bax_[i] = bay_[i] = 0.f;
+        return;
+    }
+
+    switch (P.solver) {
+        case Solver::ParticleMesh:
+            computeForcesParticleMesh(bax_, bay_);
+            break;
+        case Solver::BarnesHut:
+            tree_.build(S.x.data(), S.y.data(), S.q.data(), n, P.boundsW, P.boundsH);
+            pool().parallelFor(m, kRowGrain * 4, [&](size_t b, size_t e, unsigned) {
+                for (size_t a = b; a < e; ++a) {
+                    const uint32_t i = active_[a];
+                    const sf::Vector2f f = tree_.field(i, P.theta, P.softening2);
+                    const float s = P.k * S.q[i] * S.invMass[i];
+                    bax_[i] = s * f.x;
+                    bay_[i] = s * f.y;
+                }
+            });
+            break;
+        case Solver::Naive:
+        default:
+            pool().parallelFor(m, kRowGrain / 4, [&](size_t b, size_t e, unsigned) {
+                for (size_t a = b; a < e; ++a) {
+                    const uint32_t i = active_[a];
+                    kernels::coulombRows(P.isa, S.x.data(), S.y.data(), S.q.data(), S.invMass.data(),
+                                         n, P.k, P.softening2, i, i + 1, bax_.data(), bay_.data());
+                }
+            });
+            break;
+    }
+    uint32_t hits = 0;
+    for (uint32_t i : active_) hits += clampMag(bax_[i], bay_[i], P.maxAccel);
+    if (diagOn_) diagPart_[0].clampHits += hits;
+}
+
+// One dt split into 2^L ticks (L = maxLevel). A particle on level k ends one
+// step and starts the next every 2^(L-k) ticks: it gets a fresh force, closes
+// the old step with a half kick, picks its next level and opens the new step
+// with another half kick. Every particle then drifts to the next tick at
+// which anyone is due (kick-drift-kick leapfrog per particle). Levels may
+// drop (finer) at any step boundary but rise (coarser) by one at a time and
+// only on a tick aligned with the coarser step.
+//
+// The closing half kick of the last step happens at the start of the next
+// block, so between advance() calls velocities lead positions by half a kick.
+void Simulator::advanceBlock(float dt) {
+    const size_t n = store_.size();
+    const unsigned L = std::min(P.maxLevel, kMaxBlockLevel);
+    const uint64_t ticks = uint64_t(1) << L;
+    const float tick = dt / float(ticks);
+    const float eps = std::sqrt(P.softening2);
+
+    if (level_.size() != n) level_.assign(n, kNoLevel); // safety net; edits reset level_ themselves
+    for (auto& k : level_)
+        if (k != kNoLevel && k > L) k = uint8_t(L);     // maxLevel was lowered
+
+    auto& S = store_;
+    uint32_t count[kMaxBlockLevel + 1] = {};
+    unsigned deepest = 0;
+    uint64_t t = 0;
+    while (t < ticks) {
+        // Step starts at tick t; level k steps every (ticks >> k) ticks
+        active_.clear();
+        for (size_t i = 0; i < n; ++i) {
+            const unsigned k = (level_[i] == kNoLevel) ? 0u : level_[i];
+            if ((t & ((ticks >> k) - 1)) == 0) active_.push_back(uint32_t(i));
+        }
+        {
+            prof::Scope forces(prof_, prof::Phase::Forces);
+            computeForcesActive();
+        }
+
+        prof::Scope integrate(prof_, prof::Phase::Integrate); // kicks through drift
+        pool().parallelFor(active_.size(), kLoopGrain / 4, [&](size_t b, size_t e, unsigned) {
+            for (size_t a = b; a < e; ++a) {
+                const uint32_t i = active_[a];
+                const float axn = bax_[i], ayn = bay_[i];
+                const float amag = std::sqrt(axn*axn + ayn*ayn);
+
+                float want = INFINITY; // s
+                if (amag > 0.f && eps > 0.f) want = P.eta * std::sqrt(eps / amag);
+                const uint8_t old = level_[i];
+                if (old != kNoLevel) {
+                    const float jx = axn - ax_[i], jy = ayn - ay_[i];
+                    const float jerk = std::sqrt(jx*jx + jy*jy) / (dt / float(uint64_t(1) << old)); // m/s^3
+                    if (jerk > 0.f) want = std::min(want, P.eta * amag / jerk);
+                }
+
+                unsigned k = 0;
+                while (k < L && dt / float(uint64_t(1) << k) > want) ++k;
+                if (old != kNoLevel && k < old) {
+                    k = old - 1u;                                  // one level coarser at most
+                    if ((t & ((ticks >> k) - 1)) != 0) k = old;   // and only when in sync
+                }
+                level_[i] = uint8_t(k);
+
+                // close the old step, open the new one
+                float h = 0.5f * dt / float(uint64_t(1) << k);
+                if (old != kNoLevel) h += 0.5f * dt / float(uint64_t(1) << old);
+                S.vx[i] += axn * h;
+                S.vy[i] += ayn * h;
+                ax_[i] = axn;
+                ay_[i] = ayn;
+            }
+        });
+
+        // Next tick at which any level starts a step
+        for (auto& c : count) c = 0;
+        for (size_t i = 0; i < n; ++i) ++count[level_[i]];
+        uint64_t next = ticks;
+        for (unsigned k = 0; k <= L; ++k) {
+            if (!count[k]) continue;
+            const uint64_t stride = ticks >> k;
+            next = std::min(next, (t / stride + 1) * stride);
+            deepest = std::max(deepest, k);
+        }
+
+        const float h = float(next - t) * tick;
+        pool().parallelFor(n, kLoopGrain, [&](size_t b, size_t e, unsigned) {
+            for (size_t i = b; i < e; ++i) {
+                S.x[i] += S.vx[i] * h;
+                S.y[i] += S.vy[i] * h;
+            }
+        });
+        integrate.stop();
+        applyContactsAndBounds();
+
+        ++blockStats_.substeps;
+        blockStats_.forceEvals += active_.size();
+        blockStats_.particleSubsteps += n;
+        t = next;
+    }
+
+    ++blockStats_.blocks;
+    blockStats_.forceEvalsShared += uint64_t(n) << deepest;
+    for (unsigned k = 0; k <= kMaxBlockLevel; ++k) blockStats_.levelCount[k] = (k <= L) ? count[k] : 0;
+}
@@ -0,0 +1,313 @@
+// Shared-dt steps in every precision. The scalar policy, electrostatics,
+// softening, Boris, walls and diagnostics become template arguments once per
+// advance() call.
+#include "Simulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace {
+
+enum class Walls { None, Reflect, Periodic };
+
+// f(std::true_type) or f(std::false_type)
+template <class F> void withFlag(bool b, F&& f) {
+    if (b) f(std::true_type{});
+    else   f(std::false_type{});
+}
+
+template <class F> void withWalls(Walls w, F&& f) {
+    switch (w) {
+        case Walls::Reflect:  f(std::integral_constant<Walls, Walls::Reflect>{});  break;
+        case Walls::Periodic: f(std::integral_constant<Walls, Walls::Periodic>{}); break;
+        case Walls::None:
+        default:              f(std::integral_constant<Walls, Walls::None>{});     break;
+    }
+}
+
+// Targets [b, e):  a_i = k q_i / m_i sum_j q_j r_ij / R^3,  R^2 = |r_ij|^2 + soft2,
+// pair terms in Pol::real, row sums in Pol::accum. Soft (soft2 > 0) keeps R
+// away from zero for every pair, so only the unsoftened kernel masks
+// zero-separation pairs. Pot also writes phi_i = sum_j q_j / R, j != i.
+template <class Pol, bool Soft, bool Pot>
+void rowsPrecise(const typename Pol::real* x, const typename Pol::real* y,
+                 const float* q, const float* invMass, size_t n, double k, double soft2,
+                 size_t b, size_t e, double* ax, double* ay, double* phi) {
+    using R = typename Pol::real;
+    using A = typename Pol::accum;
+    constexpr size_t L = 8; // source j sums into lane j % L, so the loop vectorizes
+    const size_t nL = n & ~(L - 1);
+    const R s2 = R(soft2);
+    auto pair = [&](R xi, R yi, size_t j, A& sx, A& sy, A& sp) {
+        const R rx = xi - x[j], ry = yi - y[j];
+        const R d2 = rx*rx + ry*ry;
+        R r2 = d2;
+        if constexpr (Soft) r2 += s2;
+        const R invR = R(1) / std::sqrt(r2);
+        R w = R(q[j]) * ((invR * invR) * invR);
+        if constexpr (!Soft) w = d2 > R(0) ? w : R(0);
+        sx += A(w * rx);
+        sy += A(w * ry);
+        if constexpr (Pot) sp += d2 > R(0) ? A(R(q[j]) * invR) : A(0);
+    };
+    for (size_t i = b; i < e; ++i) {
+        const R xi = x[i], yi = y[i];
+        A sx[L] = {}, sy[L] = {}, sp[L] = {};
+        for (size_t j = 0; j < nL; j += L)
+            for (size_t l = 0; l < L; ++l) pair(xi, yi, j + l, sx[l], sy[l], sp[l]);
+        for (size_t j = nL; j < n; ++j) pair(xi, yi, j, sx[j - nL], sy[j - nL], sp[j - nL]);
+        A tx = 0, ty = 0, tp = 0;
+        for (size_t l = 0; l < L; ++l) { tx += sx[l]; ty += sy[l]; tp += sp[l]; }
+        const A scale = A(k) * A(q[i]) * A(invMass[i]);
+        ax[i] = double(scale * tx); // m/s^2
+        ay[i] = double(scale * ty);
+        if constexpr (Pot) phi[i] = double(tp);
+    }
+}
+
+// Columns one step touches: state in R, accelerations and potential in A.
+// With R = float the state is the store itself and the mirror pointers alias it.
+template <class R, class A>
+struct Cols {
+    R *x, *y, *vx, *vy;
+    float *fx, *fy, *fvx, *fvy;
+    const float *q, *invMass, *mass, *radius;
+    const A *ax, *ay, *phi; // phi null when there is no potential this step
+};
+
+struct Sums { double kinetic = 0.0, qphi = 0.0, px = 0.0, py = 0.0; };
+
+// Kick and drift over [b, e): symplectic Euler, or Boris with E around Bz(x_t)
+//   v- = v + a dt/2,  v' = v- + v- x t,  v+ = v- + v' x s,  v = v+ + a dt/2
+// with t = (q/m) Bz dt/2, s = 2t / (1 + t^2), an exact rotation that keeps |v|
+// at any dt. Diag sums K (mean of |v|^2 before and after the kick), p and q_i phi_i.
+template <class R, class A, bool Electro, bool Boris, bool Diag>
+Sums integrateRows(const Cols<R, A>& c, size_t b, size_t e, R dt, const Simulator::Params& P) {
+    const R half = R(0.5) * dt;
+    const R bw = R(P.boundsW), bh = R(P.boundsH);
+    const R b0 = R(P.bz), gx = R(P.bzGradX), gy = R(P.bzGradY);
+    const R cx = R(0.5) * bw, cy = R(0.5) * bh;
+    Sums s;
+    for (size_t i = b; i < e; ++i) {
+        const R ux = c.vx[i], uy = c.vy[i];
+        R vx = ux, vy = uy;
+        R ax = 0, ay = 0;
+        if constexpr (Electro) { ax = R(c.ax[i]); ay = R(c.ay[i]); }
+
+        if constexpr (Boris) {
+            const R bz = b0 + gx * (c.x[i] - cx) + gy * (c.y[i] - cy); // T
+            const R t  = R(c.q[i]) * R(c.invMass[i]) * bz * half;
+            const R sr = R(2) * t / (R(1) + t * t);
+            const R mx = vx + ax * half, my = vy + ay * half;
+            const R px = mx + my * t, py = my - mx * t;
+            vx = (mx + py * sr) + ax * half; // m/s
+            vy = (my - px * sr) + ay * half;
+        } else if constexpr (Electro) {
+            vx += ax * dt;
+            vy += ay * dt;
+        }
+        const R x = c.x[i] + vx * dt; // m
+        const R y = c.y[i] + vy * dt;
+
+        if constexpr (Diag) {
+            const double m = c.mass[i];
+            s.kinetic += 0.25 * m * ((double(ux)*ux + double(uy)*uy) + (double(vx)*vx + double(vy)*vy));
+            s.px += 0.5 * m * (double(ux) + vx);
+            s.py += 0.5 * m * (double(uy) + vy);
+            if (c.phi) s.qphi += double(c.q[i]) * c.phi[i];
+        }
+
+        c.x[i] = x;   c.y[i] = y;
+        c.vx[i] = vx; c.vy[i] = vy;
+        if constexpr (!std::is_same_v<R, float>) {
+            c.fx[i]  = float(x);  c.fy[i]  = float(y);
+            c.fvx[i] = float(vx); c.fvy[i] = float(vy);
+        }
+    }
+    return s;
+}
+
+// applyBounds over [b, e) in R, after contacts
+template <class R, class A, Walls W>
+void wallRows(const Cols<R, A>& c, size_t b, size_t e, const Simulator::Params& P) {
+    const R bw = R(P.boundsW), bh = R(P.boundsH), rest = R(P.restitution);
+    for (size_t i = b; i < e; ++i) {
+        R x = c.x[i], y = c.y[i], vx = c.vx[i], vy = c.vy[i];
+        if constexpr (W == Walls::Reflect) {
+            const R r = R(c.radius[i]);
+            if (x < r)           { x = r;      vx = -vx * rest; }
+            else if (x > bw - r) { x = bw - r; vx = -vx * rest; }
+            if (y < r)           { y = r;      vy = -vy * rest; }
+            else if (y > bh - r) { y = bh - r; vy = -vy * rest; }
+        } else if constexpr (W == Walls::Periodic) {
+            x -= bw * std::floor(x / bw);
+            y -= bh * std::floor(y / bh);
+        }
+        c.x[i] = x;   c.y[i] = y;
+        c.vx[i] = vx; c.vy[i] = vy;
+        if constexpr (!std::is_same_v<R, float>) {
+            c.fx[i]  = float(x);  c.fy[i]  = float(y);
+            c.fvx[i] = float(vx); c.fvy[i] = float(vy);
+        }
+    }
+}
+
+} // namespace
+
+void Simulator::advancePrecise(float dt, int nSteps) {
+    switch (P.precision) {
+        case Precision::Double: advancePreciseT<precision::Double>(dt, nSteps); break;
+        case Precision::Mixed:  advancePreciseT<precision::Mixed>(dt, nSteps);  break;
+        case Precision::Float:
+        default:                advancePreciseT<precision::Float>(dt, nSteps);  break;
+    }
+}
+
+// A float entry that no longer matches its rounded double was edited outside
+// the precise step (setParticle, contacts): take the float. Appended particles
+// start from their floats; everyone else keeps their double state.
+void Simulator::syncPrecise() {
+    const size_t n = store_.size();
+    const size_t kept = std::min(xd_.size(), n);
+    const auto& S = store_;
+    for (auto* col : { &xd_, &yd_, &vxd_, &vyd_ }) col->resize(n);
+    std::copy(S.x.begin() + kept,  S.x.end(),  xd_.begin() + kept);
+    std::copy(S.y.begin() + kept,  S.y.end(),  yd_.begin() + kept);
+    std::copy(S.vx.begin() + kept, S.vx.end(), vxd_.begin() + kept);
+    std::copy(S.vy.begin() + kept, S.vy.end(), vyd_.begin() + kept);
+    pool().parallelFor(kept, kLoopGrain, [&](size_t b, size_t e, unsigned) {
+        for (size_t i = b; i < e; ++i) {
+            if (S.x[i]  != float(xd_[i]))  xd_[i]  = S.x[i];
+            if (S.y[i]  != float(yd_[i]))  yd_[i]  = S.y[i];
+            if (S.vx[i] != float(vxd_[i])) vxd_[i] = S.vx[i];
+            if (S.vy[i] != float(vyd_[i])) vyd_[i] = S.vy[i];
+        }
+    });
+}
+
+template <class Pol>
+void Simulator::advancePreciseT(float dt, int nSteps) {
+    using R = typename Pol::real;
+    using A = typename Pol::accum;
+    constexpr bool realtime = std::is_same_v<Pol, precision::Float>;
+    auto& S = store_;
+    const size_t n = S.size();
+    if constexpr (Pol::kOwnState) syncPrecise();
+    if constexpr (!realtime) {
+        axd_.resize(n);
+        ayd_.resize(n);
+        if (diagOn_) phid_.resize(n);
+    }
+
+    Cols<R, A> c{};
+    if constexpr (Pol::kOwnState) {
+        c.x = xd_.data(); c.y = yd_.data(); c.vx = vxd_.data(); c.vy = vyd_.data();
+    } else {
+        c.x = S.x.data(); c.y = S.y.data(); c.vx = S.vx.data(); c.vy = S.vy.data();
+    }
+    c.fx = S.x.data(); c.fy = S.y.data(); c.fvx = S.vx.data(); c.fvy = S.vy.data();
+    c.q = S.q.data(); c.invMass = S.invMass.data(); c.mass = S.mass.data(); c.radius = S.radius.data();
+    if constexpr (realtime) { c.ax = ax_.data();  c.ay = ay_.data(); }
+    else                    { c.ax = axd_.data(); c.ay = ayd_.data(); }
+
+    const Walls walls = !boundsOn_ ? Walls::None
+                      : P.boundary == Boundary::Periodic ? Walls::Periodic : Walls::Reflect;
+    const bool boris = P.integrator == Integrator::Boris;
+    const bool naive = P.solver == Solver::Naive;
+    const double maxA = P.maxAccel;
+
+    for (int step = 0; step < nSteps; ++step) {
+        if (diagOn_) beginDiagnostics();
+        bool potential = !electroOn_; // no field: U = 0 exactly
+        {
+            prof::Scope t(prof_, prof::Phase::Forces);
+            if constexpr (realtime) {
+                // Float solvers straight into ax_ (naive: the SIMD coulombRows or pair tiles)
+                computeForces(ax_, ay_);
+                potential = potential || phiValid_;
+            } else if (electroOn_ && naive && n > 0) {
+                double* phi = diagOn_ ? phid_.data() : nullptr;
+                if constexpr (std::is_same_v<Pol, precision::Mixed>) {
+                    // Float pairs: the SIMD rows with double lanes
+                    pool().parallelFor(n, kRowGrain, [&](size_t b, size_t e, unsigned) {
+                        kernels::coulombRowsMixed(P.isa, c.x, c.y, c.q, c.invMass, n, P.k, P.softening2,
+                                                  b, e, axd_.data(), ayd_.data(), phi);
+                    });
+                } else {
+                    withFlag(P.softening2 > 0.f, [&](auto soft) {
+                        withFlag(phi != nullptr, [&](auto pot) {
+                            pool().parallelFor(n, kRowGrain, [&](size_t b, size_t e, unsigned) {
+                                rowsPrecise<Pol, decltype(soft)::value, decltype(pot)::value>(
+                                    c.x, c.y, c.q, c.invMass, n, P.k, P.softening2, b, e, axd_.data(), ayd_.data(), phi);
+                            });
+                        });
+                    });
+                }
+                pool().parallelFor(n, kLoopGrain, [&](size_t b, size_t e, unsigned w) {
+                    uint32_t hits = 0;
+                    for (size_t i = b; i < e; ++i) {
+                        const double a2 = axd_[i] * axd_[i] + ayd_[i] * ayd_[i];
+                        if (a2 <= maxA * maxA) continue;
+                        const double s = maxA / std::sqrt(a2);
+                        axd_[i] *= s; ayd_[i] *= s;
+                        ++hits;
+                    }
+                    if (diagOn_) diagPart_[w].clampHits += hits;
+                });
+                potential = phi != nullptr;
+            } else if (electroOn_) {
+                // Float solvers read the (mirrored) store
+                computeForces(ax_, ay_);
+                const bool phiIn = diagOn_ && phiValid_;
+                pool().parallelFor(n, kLoopGrain, [&](size_t b, size_t e, unsigned) {
+                    for (size_t i = b; i < e; ++i) {
+                        axd_[i] = ax_[i];
+                        ayd_[i] = ay_[i];
+                        if (phiIn) phid_[i] = phi_[i];
+                    }
+                });
+                potential = phiIn;
+            }
+        }
+        const A* phi = nullptr;
+        if constexpr (realtime) phi = phi_.data();
+        else                    phi = phid_.data();
+        c.phi = (diagOn_ && electroOn_ && potential) ? phi : nullptr;
+
+        {
+            prof::Scope t(prof_, prof::Phase::Integrate);
+            withFlag(electroOn_, [&](auto electro) {
+            withFlag(boris, [&](auto bor) {
+            withFlag(diagOn_, [&](auto diag) {
+                constexpr bool Diag = decltype(diag)::value;
+                pool().parallelFor(n, kLoopGrain, [&](size_t b, size_t e, unsigned w) {
+                    const Sums s = integrateRows<R, A, decltype(electro)::value, decltype(bor)::value, Diag>(
+                        c, b, e, R(dt), P);
+                    if constexpr (Diag) {
+                        DiagPartial& d = diagPart_[w];
+                        d.kinetic += s.kinetic; d.qphi += s.qphi; d.px += s.px; d.py += s.py;
+                    }
+                });
+            }); }); });
+        }
+
+        if (diagOn_) {
+            endDiagnostics(diagClock_, potential);
+            diagClock_ += dt;
+        }
+        if (collisionsOn_) {
+            prof::Scope t(prof_, prof::Phase::Contacts);
+            collide_.findContacts(S, pool());
+            collide_.resolve(S, P.restitution);
+            if constexpr (Pol::kOwnState) syncPrecise(); // take the contact impulses
+        }
+        if (walls != Walls::None) {
+            prof::Scope t(prof_, prof::Phase::Bounds);
+            withWalls(walls, [&](auto wall) {
+                pool().parallelFor(n, kLoopGrain, [&](size_t b, size_t e, unsigned) {
+                    wallRows<R, A, decltype(wall)::value>(c, b, e, P);
+                });
+            });
+        }
+    }
+}
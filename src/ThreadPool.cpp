@@ -0,0 +1,66 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+unsigned ThreadPool::resolveThreads(unsigned requested) {
+    if (requested != 0) return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(unsigned threads) {
+    const unsigned total = resolveThreads(threads);
+    workers_.reserve(total - 1);
+    for (unsigned w = 1; w < total; ++w)
+        workers_.emplace_back([this, w] { workerLoop(w); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void ThreadPool::run(size_t n, size_t grain, Body body, void* ctx) {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        body_ = body; ctx_ = ctx;
+        n_ = n; grain_ = grain;
+        next_.store(0, std::memory_order_relaxed);
+        pending_.store(static_cast<unsigned>(workers_.size()), std::memory_order_relaxed);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    work(0); // the caller takes chunks too
+
+    std::unique_lock<std::mutex> lk(m_);
+    done_.wait(lk, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+}
+
+void ThreadPool::work(unsigned worker) {
+    for (;;) {
+        const size_t b = next_.fetch_add(grain_, std::memory_order_relaxed);
+        if (b >= n_) return;
+        body_(ctx_, b, std::min(b + grain_, n_), worker);
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            wake_.wait(lk, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+        work(worker);
+        // Last one out wakes the caller
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lk(m_);
+            done_.notify_one();
+        }
+    }
+}
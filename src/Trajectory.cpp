@@ -0,0 +1,335 @@
+#include "Trajectory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace traj;
+
+static size_t pad8(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+template <class T>
+static void append(std::vector<uint8_t>& out, const T* data, size_t count) {
+    const size_t at = out.size();
+    out.resize(at + count * sizeof(T));
+    if (count) std::memcpy(out.data() + at, data, count * sizeof(T));
+}
+
+static void alignTo8(std::vector<uint8_t>& out) { out.resize(pad8(out.size()), 0); }
+
+// ---------------------------------------------------------------- writer
+
+TrajectoryWriter::~TrajectoryWriter() { close(); }
+
+bool TrajectoryWriter::open(const std::string& path, const Simulator::Params& P, float dt, const Options& o) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) return false;
+
+    opt_ = o;
+    opt_.every = std::max(1u, o.every);
+    opt_.keyInterval = std::max(1u, o.keyInterval);
+
+    header_ = FileHeader{};
+    std::memcpy(header_.magic, kMagic, sizeof(kMagic));
+    header_.version     = kVersion;
+    header_.headerBytes = sizeof(FileHeader);
+    header_.dt          = dt;
+    header_.every       = opt_.every;
+    header_.quantum     = opt_.quantum;
+    header_.keyInterval = opt_.keyInterval;
+    header_.k           = P.k;
+    header_.softening2  = P.softening2;
+    header_.boundsW     = P.boundsW;
+    header_.boundsH     = P.boundsH;
+    header_.restitution = P.restitution;
+    header_.maxAccel    = P.maxAccel;
+    header_.theta       = P.theta;
+    header_.p3mSplit    = P.p3mSplit;
+    header_.solver      = uint32_t(P.solver);
+    header_.boundary    = uint32_t(P.boundary);
+    header_.pmGrid      = P.pmGrid;
+    header_.p3m         = P.p3m ? 1u : 0u;
+    header_.integrator  = uint32_t(P.integrator);
+    header_.maxLevel    = P.maxLevel;
+    header_.eta         = P.eta;
+    header_.bz          = P.bz;
+    header_.bzGradX     = P.bzGradX;
+    header_.bzGradY     = P.bzGradY;
+    header_.precision   = uint32_t(P.precision);
+
+    steps_ = 0;
+    started_ = false;
+    index_.clear();
+    sinceKey_ = 0;
+    keyOffset_ = 0;
+    stopIo_ = false;
+    ioFailed_ = false;
+
+    std::vector<uint8_t> block;
+    append(block, &header_, 1);
+    offset_ = 0;
+    io_ = std::thread([this] { ioLoop(); });
+    submit(std::move(block));
+    return true;
+}
+
+void TrajectoryWriter::close() {
+    if (!file_) return;
+
+    // Index after the last frame, then patch the header
+    std::vector<uint8_t> block;
+    const uint64_t indexOffset = offset_;
+    append(block, index_.data(), index_.size());
+    submit(std::move(block));
+
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stopIo_ = true;
+    }
+    cv_.notify_all();
+    if (io_.joinable()) io_.join();
+
+    header_.frameCount  = index_.size();
+    header_.indexOffset = indexOffset;
+    if (!ioFailed_ && std::fseek(file_, 0, SEEK_SET) == 0)
+        std::fwrite(&header_, sizeof(header_), 1, file_);
+    std::fclose(file_);
+    file_ = nullptr;
+    full_.clear();
+    free_.clear();
+}
+
+void TrajectoryWriter::advance(Simulator& sim, float dt, int nSteps) {
+    if (!file_) { sim.advance(dt, nSteps); return; }
+    if (!started_) { record(sim.store()); started_ = true; }
+
+    while (nSteps > 0) {
+        const int untilFrame = int(opt_.every - steps_ % opt_.every);
+        const int chunk = std::min(nSteps, untilFrame);
+        sim.advance(dt, chunk);
+        steps_ += uint64_t(chunk);
+        nSteps -= chunk;
+        if (steps_ % opt_.every == 0) record(sim.store());
+    }
+}
+
+void TrajectoryWriter::record(const ParticleStore& s) {
+    if (!file_) return;
+
+    std::vector<uint8_t> block;
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        if (!free_.empty()) { block = std::move(free_.back()); free_.pop_back(); }
+    }
+    block.clear();
+
+    const bool needKey = index_.empty() || sinceKey_ >= opt_.keyInterval || s.size() != keyX_.size();
+    if (needKey || !writeDelta(s, block)) {
+        block.clear();
+        writeKey(s, block);
+    }
+    submit(std::move(block));
+}
+
+void TrajectoryWriter::writeKey(const ParticleStore& s, std::vector<uint8_t>& out) {
+    const size_t n = s.size();
+    FrameHeader fh{};
+    fh.tag  = kKeyTag;
+    fh.n    = uint32_t(n);
+    fh.step = steps_;
+    fh.time = double(steps_) * header_.dt;
+    fh.payloadBytes = pad8(n * (3 * sizeof(float) + sizeof(Rgba8)));
+    fh.keyOffset = offset_;
+
+    append(out, &fh, 1);
+    append(out, s.x.data(), n);
+    append(out, s.y.data(), n);
+    append(out, s.radius.data(), n);
+    append(out, s.color.data(), n);
+    alignTo8(out);
+
+    keyX_.assign(s.x.begin(), s.x.end());
+    keyY_.assign(s.y.begin(), s.y.end());
+    keyOffset_ = offset_;
+    sinceKey_ = 1;
+    index_.push_back({ offset_, offset_ });
+}
+
+// false (and nothing usable in out) if some particle drifted out of int16 range
+bool TrajectoryWriter::writeDelta(const ParticleStore& s, std::vector<uint8_t>& out) {
+    const size_t n = s.size();
+    FrameHeader fh{};
+    fh.tag  = kDeltaTag;
+    fh.n    = uint32_t(n);
+    fh.step = steps_;
+    fh.time = double(steps_) * header_.dt;
+    fh.payloadBytes = pad8(n * 2 * sizeof(int16_t));
+    fh.keyOffset = keyOffset_;
+
+    append(out, &fh, 1);
+    const size_t base = out.size();
+    out.resize(base + fh.payloadBytes, 0);
+    int16_t* dx = reinterpret_cast<int16_t*>(out.data() + base);
+    int16_t* dy = dx + n;
+
+    const float inv = 1.0f / header_.quantum;
+    for (size_t i = 0; i < n; ++i) {
+        const float qx = std::nearbyint((s.x[i] - keyX_[i]) * inv);
+        const float qy = std::nearbyint((s.y[i] - keyY_[i]) * inv);
+        if (!(std::fabs(qx) <= 32767.f && std::fabs(qy) <= 32767.f)) return false; // also NaN
+        dx[i] = int16_t(qx);
+        dy[i] = int16_t(qy);
+    }
+
+    ++sinceKey_;
+    index_.push_back({ offset_, keyOffset_ });
+    return true;
+}
+
+void TrajectoryWriter::submit(std::vector<uint8_t>&& block) {
+    const size_t bytes = block.size();
+    {
+        std::unique_lock<std::mutex> lk(m_);
+        // Backpressure: a disk far slower than the sim eventually throttles it
+        cv_.wait(lk, [&] { return full_.size() < 16 || ioFailed_; });
+        full_.push_back(std::move(block));
+    }
+    cv_.notify_all();
+    offset_ += bytes;
+}
+
+void TrajectoryWriter::ioLoop() {
+    std::unique_lock<std::mutex> lk(m_);
+    for (;;) {
+        cv_.wait(lk, [&] { return stopIo_ || !full_.empty(); });
+        if (full_.empty()) return; // stopIo_ and drained
+
+        std::vector<uint8_t> block = std::move(full_.front());
+        full_.pop_front();
+        lk.unlock();
+        cv_.notify_all();
+
+        const bool ok = std::fwrite(block.data(), 1, block.size(), file_) == block.size();
+
+        lk.lock();
+        if (!ok) ioFailed_ = true;
+        free_.push_back(std::move(block));
+    }
+}
+
+// ---------------------------------------------------------------- reader
+
+TrajectoryReader::~TrajectoryReader() { close(); }
+
+bool TrajectoryReader::open(const std::string& path) {
+    close();
+    if (!map_.open(path)) return false;
+    data_ = map_.data();
+    size_ = map_.size();
+    if (size_ < sizeof(FileHeader)
+        || std::memcmp(header().magic, kMagic, sizeof(kMagic)) != 0
+        || header().version < 1 || header().version > kVersion
+        || header().solver > uint32_t(Simulator::Solver::ParticleMesh)
+        || header().boundary > uint32_t(Simulator::Boundary::Periodic)
+        || (header().version >= 2 && (header().integrator > uint32_t(Simulator::Integrator::Boris)
+                                      || header().precision > uint32_t(Simulator::Precision::Double)))) {
+        close();
+        return false;
+    }
+
+    // Checked by subtraction: file values must not wrap the bounds check
+    const FileHeader& h = header();
+    if (h.indexOffset != 0 && h.indexOffset % 8 == 0 && h.indexOffset <= size_
+        && h.frameCount <= (size_ - h.indexOffset) / sizeof(IndexEntry)) {
+        const auto* idx = reinterpret_cast<const IndexEntry*>(data_ + h.indexOffset);
+        index_.assign(idx, idx + h.frameCount);
+    } else {
+        // Unfinished recording: walk the frame chain, stopping at the first torn frame
+        uint64_t off = h.headerBytes;
+        while (const FrameHeader* fh = at(off)) {
+            index_.push_back({ off, fh->keyOffset });
+            off += sizeof(FrameHeader) + fh->payloadBytes;
+        }
+    }
+    return true;
+}
+
+void TrajectoryReader::close() {
+    map_.close();
+    data_ = nullptr;
+    size_ = 0;
+    index_.clear();
+}
+
+// Frame header at offset, or nullptr if it (or its payload) is not fully in the file
+const FrameHeader* TrajectoryReader::at(uint64_t offset) const {
+    if (offset % 8 != 0 || offset + sizeof(FrameHeader) > size_) return nullptr;
+    const auto* fh = reinterpret_cast<const FrameHeader*>(data_ + offset);
+    if (fh->tag != kKeyTag && fh->tag != kDeltaTag) return nullptr;
+    const size_t need = fh->tag == kKeyTag ? size_t(fh->n) * (3 * sizeof(float) + sizeof(Rgba8))
+                                           : size_t(fh->n) * 2 * sizeof(int16_t);
+    if (fh->payloadBytes < need || fh->payloadBytes > size_ - offset - sizeof(FrameHeader)) return nullptr;
+    return fh;
+}
+
+Simulator::Params TrajectoryReader::params() const {
+    Simulator::Params P;
+    const FileHeader& h = header();
+    P.k           = h.k;
+    P.softening2  = h.softening2;
+    P.boundsW     = h.boundsW;
+    P.boundsH     = h.boundsH;
+    P.restitution = h.restitution;
+    P.maxAccel    = h.maxAccel;
+    P.theta       = h.theta;
+    P.p3mSplit    = h.p3mSplit;
+    P.solver      = Simulator::Solver(h.solver);
+    P.boundary    = Simulator::Boundary(h.boundary);
+    P.pmGrid      = h.pmGrid;
+    P.p3m         = h.p3m != 0;
+    if (h.version >= 2) {
+        P.integrator = Simulator::Integrator(h.integrator);
+        P.maxLevel   = h.maxLevel;
+        P.eta        = h.eta;
+        P.bz         = h.bz;
+        P.bzGradX    = h.bzGradX;
+        P.bzGradY    = h.bzGradY;
+        P.precision  = Simulator::Precision(h.precision);
+    }
+    return P;
+}
+
+TrajectoryReader::Frame TrajectoryReader::frame(size_t i) {
+    Frame f;
+    if (i >= index_.size()) return f;
+    const FrameHeader* fh = at(index_[i].offset);
+    const FrameHeader* kh = at(index_[i].keyOffset);
+    if (!fh || !kh || kh->tag != kKeyTag || kh->n != fh->n) return f;
+
+    const size_t n = fh->n;
+    const auto* key = reinterpret_cast<const float*>(kh + 1);
+    f.n      = n;
+    f.step   = fh->step;
+    f.time   = fh->time;
+    f.radius = key + 2 * n;
+    f.color  = reinterpret_cast<const Rgba8*>(key + 3 * n);
+
+    if (fh->tag == kKeyTag) { // zero-copy
+        f.x = key;
+        f.y = key + n;
+        return f;
+    }
+
+    const auto* dx = reinterpret_cast<const int16_t*>(fh + 1);
+    const auto* dy = dx + n;
+    const float qm = header().quantum;
+    x_.resize(n);
+    y_.resize(n);
+    for (size_t j = 0; j < n; ++j) {
+        x_[j] = key[j]     + float(dx[j]) * qm;
+        y_[j] = key[n + j] + float(dy[j]) * qm;
+    }
+    f.x = x_.data();
+    f.y = y_.data();
+    return f;
+}
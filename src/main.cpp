@@ -1,19 +1,126 @@
 #include <SFML/Graphics.hpp>
 #include "Simulator.hpp"
+#include "Diagnostics.hpp"
+#include "FieldMap.hpp"
 #include "Particle.hpp"
+#include "ParticleRenderer.hpp"
+#include "PhysicsThread.hpp"
+#include "Profiler.hpp"
+#include "Scenes.hpp"
+#include "Trajectory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 enum class Mode { Custom, ElectronGun };
 
-//add magnetic field
-int main() {
+// --replay: play back a recorded trajectory (no simulation).
+// Space play/pause, Left/Right one frame, Up/Down one keyframe interval, Home/End.
+static int runReplay(const std::string& path) {
+    TrajectoryReader rec;
+    if (!rec.open(path)) {
+        std::cout << "Cannot open trajectory " << path << "\n";
+        return 1;
+    }
+    const Simulator::Params P = rec.params();
+    const float frameDt = rec.header().dt * float(rec.header().every); // s of sim time per frame
+    const size_t frames = rec.frameCount();
+
+    unsigned W = 800, H = 600;
+    float ppm = std::min(W / P.boundsW, H / P.boundsH);
+    sf::RenderWindow window(sf::VideoMode(W, H), "ElectroSim replay");
+    window.setFramerateLimit(120);
+    sf::View view(sf::FloatRect(0.f, 0.f, (float)W, (float)H));
+    window.setView(view);
+
+    sf::Font uiFont;
+    const bool fontOk = uiFont.loadFromFile("assets/fonts/RobotoRegular-3m4L.ttf");
+
+    ParticleRenderer renderer;
+    sf::Clock clock;
+    bool playing = true;
+    double playTime = 0.0; // s of sim time from the first frame
+
+    while (window.isOpen()) {
+        sf::Event e;
+        while (window.pollEvent(e)) {
+            if (e.type == sf::Event::Closed) window.close();
+            if (e.type == sf::Event::Resized) {
+                W = e.size.width; H = e.size.height;
+                ppm = std::min(W / P.boundsW, H / P.boundsH);
+                view.setSize((float)W, (float)H);
+                view.setCenter(W / 2.f, H / 2.f);
+                window.setView(view);
+            }
+            if (e.type == sf::Event::KeyPressed) {
+                const double key = double(frameDt) * rec.header().keyInterval;
+                if (e.key.code == sf::Keyboard::Space) playing = !playing;
+                if (e.key.code == sf::Keyboard::Right) playTime += frameDt;
+                if (e.key.code == sf::Keyboard::Left)  playTime -= frameDt;
+                if (e.key.code == sf::Keyboard::Up)    playTime += key;
+                if (e.key.code == sf::Keyboard::Down)  playTime -= key;
+                if (e.key.code == sf::Keyboard::Home)  playTime = 0.0;
+                if (e.key.code == sf::Keyboard::End)   playTime = double(frameDt) * double(frames);
+            }
+        }
+
+        const float wall = clock.restart().asSeconds();
+        if (playing) playTime += std::min(wall, 0.25f);
+        playTime = std::clamp(playTime, 0.0, frames ? double(frameDt) * double(frames - 1) : 0.0);
+
+        // Frames are evenly spaced in sim time, so the index is a direct lookup
+        const size_t idx = frames ? std::min(frames - 1, size_t(playTime / frameDt + 0.5)) : 0;
+        const TrajectoryReader::Frame f = rec.frame(idx);
+
+        window.clear(sf::Color::Black);
+        renderer.draw(window, f.x, f.y, f.radius, f.color, f.n, ppm);
+        if (fontOk) {
+            char buf[128];
+            std::snprintf(buf, sizeof(buf), "frame %zu / %zu   t = %.3f s   n = %zu%s",
+                          idx, frames, f.time, f.n, playing ? "" : "   (paused)");
+            sf::Text lbl(buf, uiFont, 16);
+            lbl.setFillColor(sf::Color(200,200,200));
+            lbl.setPosition(12.f, 12.f);
+            window.draw(lbl);
+        }
+        window.display();
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // --sync: step physics inside the render loop instead of on its own thread
+    // --record file [--record-every k]: stream the run to a trajectory file
+    // --replay file: play a recorded trajectory instead of simulating
+    // --load file: start from a checkpoint (F5 saves, F9 reloads checkpoint.esck)
+    // --profile-out base: write base.csv and base.json (Chrome trace) on exit (F2 dumps profile.*)
+    bool syncPhysics = false;
+    std::string recordPath, replayPath, loadPath, profilePath;
+    unsigned recordEvery = 1;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a == "--sync") syncPhysics = true;
+        else if (a == "--record" && hasValue)       recordPath = argv[++i];
+        else if (a == "--record-every" && hasValue) recordEvery = unsigned(std::max(1, std::atoi(argv[++i])));
+        else if (a == "--replay" && hasValue)       replayPath = argv[++i];
+        else if (a == "--load" && hasValue)         loadPath = argv[++i];
+        else if (a == "--profile-out" && hasValue)  profilePath = argv[++i];
+    }
+    if (!replayPath.empty()) return runReplay(replayPath);
+
     // -------------------------------
     // Window + render scale
     // -------------------------------
     unsigned W = 800, H = 600;       // pixels
     float ppm = 100.0f;          // pixels per meter (100 px = 1 m)
 
-    const float WORLD_W_M = W / ppm;
-    const float WORLD_H_M = H / ppm;
+    float worldW = W / ppm; // meters the window is fitted to (resizes keep it, loads replace it)
+    float worldH = H / ppm;
 
     sf::RenderWindow window(sf::VideoMode(W, H), "ElectroSim (SI units)");
     window.setFramerateLimit(120);
@@ -35,11 +142,31 @@ int main() {
     prm.softening2  = (0.05f * 0.05f);               // (0.01 m)^2
     prm.restitution = 0.9f;                // mirror walls
     prm.maxAccel    = 1.0e4f;              // m/s^2 clamp for safety
+    prm.p3m         = true;                // mesh solver adds the exact near field (M toggles)
 
 
     Simulator sim(prm);
     sim.setBoundsEnabled(false);
     sim.setElectrostaticsEnabled(true);
+    if (!loadPath.empty() && !sim.loadCheckpoint(loadPath))
+        std::cout << "Cannot load checkpoint " << loadPath << "\n";
+
+    // Per-phase timings for the HUD (P toggles it) and F2 / --profile-out dumps
+    prof::Profiler profiler;
+    sim.setProfiler(&profiler);
+    bool showProfile = prof::kEnabled;
+    uint64_t syncSteps = 0, lastSteps = 0; // for steps per frame
+    double syncDropped = 0.0;              // s, --sync mode
+    auto dumpProfile = [&](const std::string& base) {
+        if (!profiler.writeCsv(base + ".csv") || !profiler.writeChromeTrace(base + ".json"))
+            std::cout << "Cannot write profile " << base << ".csv/.json\n";
+    };
+
+    // Energy / momentum graph (E toggles it and the Simulator's diagnostics)
+    bool showEnergy = false;
+    DiagnosticsSeries energyHist(600); // one point per new step seen by a frame
+    uint64_t lastDiagStep = 0;
+    sf::VertexArray energyLine(sf::LineStrip), momentumLine(sf::LineStrip);
 
     bool paused = true;
     
@@ -51,7 +178,12 @@ int main() {
     // --- UI state for inputs (SI units) ---
     float uiCharge = 8e-7f;   // Coulombs
     float uiMass   = 2e-3f;   // kg
-    float uiBz     = 0.0f;    // Tesla (out-of-screen), placeholder (not applied yet)
+    float uiBz     = sim.params().bz; // Tesla (out-of-screen), uniform Params::bz
+
+    // Params last seen in a snapshot, and the bounds the last resize asked for.
+    // Bounds that change to anything else came from a checkpoint load.
+    float seenW = prm.boundsW, seenH = prm.boundsH, seenBz = uiBz;
+    float askedW = prm.boundsW, askedH = prm.boundsH;
 
     // Layout for three rows (top-right panel)
     const sf::Vector2f rowSize{ 208.f, 32.f };
@@ -109,12 +241,125 @@ int main() {
         }
     };
     
+    ParticleRenderer renderer;
+
+    // Field overlay: F cycles off -> potential -> |E|, G toggles arrows.
+    // Evaluated on the render thread with half the cores (the physics thread
+    // keeps the rest), one sample per 8 px, at most ~12 refreshes per second.
+    enum class FieldView { Off, Potential, Magnitude };
+    FieldView fieldView = FieldView::Off;
+    bool fieldArrows = false;
+    FieldMap fieldMap;
+    ThreadPool fieldPool(std::max(1u, ThreadPool::resolveThreads(0) / 2));
+    sf::Texture fieldTex;
+    sf::Sprite fieldSprite;
+    sf::VertexArray fieldGlyphs(sf::Lines);
+    std::vector<uint8_t> fieldRgba;
+    bool fieldStale = true; // view changed: rebuild texture/glyphs from the current map
+
+    // Signed potential: asinh scale, red +, blue -. |E|: log scale over 4 decades.
+    auto rebuildField = [&]() {
+        const unsigned cols = fieldMap.cols(), rows = fieldMap.rows();
+        const auto& phi = fieldMap.potential();
+        const auto& fx = fieldMap.ex();
+        const auto& fy = fieldMap.ey();
+        const size_t cells = phi.size();
+
+        float phiMax = 0.f, eMax = 0.f;
+        for (size_t s = 0; s < cells; ++s) {
+            phiMax = std::max(phiMax, std::fabs(phi[s]));
+            eMax = std::max(eMax, std::hypot(fx[s], fy[s]));
+        }
+        const float phiRef = std::max(phiMax * 1e-3f, 1e-30f);
+        const float phiNorm = 1.0f / std::max(std::asinh(phiMax / phiRef), 1e-6f);
+        const float eLogMax = std::log10(std::max(eMax, 1e-30f));
+        auto eLevel = [&](float e) { // 0..1
+            return std::clamp((std::log10(std::max(e, 1e-30f)) - eLogMax + 4.f) * 0.25f, 0.f, 1.f);
+        };
+
+        fieldRgba.resize(cells * 4);
+        for (size_t s = 0; s < cells; ++s) {
+            uint8_t* px = &fieldRgba[s * 4];
+            if (fieldView == FieldView::Potential) {
+                const float t = std::clamp(std::asinh(phi[s] / phiRef) * phiNorm, -1.f, 1.f);
+                const uint8_t a = uint8_t(255.f * std::fabs(t));
+                px[0] = t > 0.f ? a : 0; px[1] = 0; px[2] = t < 0.f ? a : 0; px[3] = 255;
+            } else { // black -> purple -> orange -> yellow
+                const float t = eLevel(std::hypot(fx[s], fy[s]));
+                px[0] = uint8_t(255.f * std::min(1.f, 1.6f * t));
+                px[1] = uint8_t(255.f * std::clamp(1.8f * t - 0.8f, 0.f, 1.f));
+                px[2] = uint8_t(255.f * std::clamp(t < 0.5f ? 1.2f * t : 1.2f * (1.f - t), 0.f, 1.f));
+                px[3] = 255;
+            }
+        }
+        if (fieldView != FieldView::Off) {
+            if (fieldTex.getSize().x != cols || fieldTex.getSize().y != rows) {
+                fieldTex.create(cols, rows);
+                fieldTex.setSmooth(true);
+                fieldSprite.setTexture(fieldTex, true);
+            }
+            fieldTex.update(fieldRgba.data());
+        }
+
+        // Unit arrows every 3rd sample (~24 px), brightness by log |E|
+        fieldGlyphs.clear();
+        if (!fieldArrows) return;
+        const float cellW = W / float(cols), cellH = H / float(rows), len = 10.f;
+        for (unsigned r = 1; r < rows; r += 3)
+            for (unsigned c = 1; c < cols; c += 3) {
+                const size_t s = size_t(r) * cols + c;
+                const float e = std::hypot(fx[s], fy[s]);
+                if (!(e > 0.f)) continue;
+                const float ux = fx[s] / e, uy = fy[s] / e;
+                const uint8_t lvl = uint8_t(80.f + 175.f * eLevel(e));
+                const sf::Color col(lvl, lvl, lvl);
+                const sf::Vector2f mid((c + 0.5f) * cellW, (r + 0.5f) * cellH);
+                const sf::Vector2f tip(mid.x + 0.5f * len * ux, mid.y + 0.5f * len * uy);
+                fieldGlyphs.append(sf::Vertex(sf::Vector2f(mid.x - 0.5f * len * ux, mid.y - 0.5f * len * uy), col));
+                fieldGlyphs.append(sf::Vertex(tip, col));
+                // head: two short strokes back from the tip, +-30 degrees
+                for (float sgn : { 1.f, -1.f }) {
+                    const float hx = -ux * 0.866f - sgn * uy * 0.5f, hy = -uy * 0.866f + sgn * ux * 0.5f;
+                    fieldGlyphs.append(sf::Vertex(tip, col));
+                    fieldGlyphs.append(sf::Vertex(sf::Vector2f(tip.x + 4.f * hx, tip.y + 4.f * hy), col));
+                }
+            }
+    };
+
     sf::Clock clock;
     float accTime = 0.0f;
     const float dt = 1.0f / 240.0f; // seconds
+
+    // Optional recording; the writer steps the sim so it sees every k-th step
+    TrajectoryWriter recorder;
+    if (!recordPath.empty()) {
+        TrajectoryWriter::Options ro;
+        ro.every = recordEvery;
+        if (!recorder.open(recordPath, sim.params(), dt, ro))
+            std::cout << "Cannot record to " << recordPath << "\n";
+    }
+
+    // Physics runs on its own thread at fixed dt; we only read its snapshots
+    std::unique_ptr<PhysicsThread> physics;
+    if (!syncPhysics) {
+        physics = std::make_unique<PhysicsThread>(sim, dt);
+        physics->setPaused(paused);
+        if (recorder.isOpen()) physics->setRecorder(&recorder);
+        physics->start();
+    }
+
+    // Every Simulator edit goes through here: queued for the physics thread,
+    // or applied on the spot in --sync mode
+    auto command = [&](PhysicsThread::Command cmd) {
+        if (physics) physics->post(std::move(cmd));
+        else         cmd(sim);
+    };
     
     while (window.isOpen()) {
+        prof::Scope frameSpan(&profiler, prof::Phase::Frame);
+
         // ---- events ----
+        prof::Scope eventsSpan(&profiler, prof::Phase::Events);
         sf::Event e;
         while (window.pollEvent(e)) {
             if (e.type == sf::Event::Closed) window.close();
@@ -122,29 +367,107 @@ int main() {
             if (e.type == sf::Event::Resized) {
                 W = e.size.width;
                 H = e.size.height;
-                float ppmX = W / WORLD_W_M;
-                float ppmY = H / WORLD_H_M;
+                float ppmX = W / worldW;
+                float ppmY = H / worldH;
                 ppm = std::min(ppmX, ppmY);
                 view.setSize((float)W, (float)H);
                 view.setCenter(W / 2.f, H / 2.f);
                 window.setView(view);
-                sim.params().boundsW = W / ppm;
-                sim.params().boundsH = H / ppm;
-                if (paused && sim.boundsEnabled()) {
-                    for (auto& p : sim.particles()) {
-                        if (p.pos.x < p.radius)                    { p.pos.x = p.radius; }
-                        if (p.pos.x > sim.params().boundsW - p.radius) { p.pos.x = sim.params().boundsW - p.radius; }
-                        if (p.pos.y < p.radius)                    { p.pos.y = p.radius; }
-                        if (p.pos.y > sim.params().boundsH - p.radius) { p.pos.y = sim.params().boundsH - p.radius; }
-                    }
-                }
+                const float bw = W / ppm, bh = H / ppm;
+                askedW = bw;
+                askedH = bh;
+                const bool clamp = paused;
+                command([bw, bh, clamp](Simulator& s) {
+                    s.params().boundsW = bw;
+                    s.params().boundsH = bh;
+                    if (clamp && s.boundsEnabled()) s.clampToBounds();
+                });
 
             }
 
 
             if (e.type == sf::Event::KeyPressed) {
-                if (e.key.code == sf::Keyboard::Space) paused = !paused;
-                if (e.key.code == sf::Keyboard::C)     sim.clear(); // clear all particles
+                if (e.key.code == sf::Keyboard::Space) {
+                    paused = !paused;
+                    if (physics) physics->setPaused(paused);
+                }
+                if (e.key.code == sf::Keyboard::C) command([](Simulator& s) { s.clear(); }); // clear all particles
+                if (e.key.code == sf::Keyboard::B) {                // cycle naive -> Barnes–Hut -> mesh
+                    command([](Simulator& s) {
+                        auto& solver = s.params().solver;
+                        solver = (solver == Simulator::Solver::Naive)     ? Simulator::Solver::BarnesHut
+                               : (solver == Simulator::Solver::BarnesHut) ? Simulator::Solver::ParticleMesh
+                                                                          : Simulator::Solver::Naive;
+                    });
+                }
+                if (e.key.code == sf::Keyboard::M) {                // mesh solver: PM <-> P3M
+                    command([](Simulator& s) { s.params().p3m = !s.params().p3m; });
+                }
+                // Procedural scenes replace the current one: 1 lattice, 2 gas, 3 dipole sheets
+                if (e.key.code == sf::Keyboard::Num1 || e.key.code == sf::Keyboard::Num2
+                    || e.key.code == sf::Keyboard::Num3) {
+                    const int which = e.key.code - sf::Keyboard::Num1;
+                    scenes::Body body;
+                    body.charge = uiCharge * 0.1f;
+                    body.mass   = uiMass;
+                    body.radius = 0.03f;
+                    command([which, body](Simulator& s) {
+                        const float w = s.params().boundsW, h = s.params().boundsH;
+                        s.clear();
+                        if (which == 0)      s.addParticles(scenes::lattice(40, 30, 0.1f * w, 0.1f * h, 0.8f * w, 0.8f * h, body));
+                        else if (which == 1) s.addParticles(scenes::randomGas(2000, w, h, 0.2f, body));
+                        else                 s.addParticles(scenes::dipoleSheets(60, 0.5f * w, 0.3f * w, 0.15f * h, 0.7f * h, body));
+                    });
+                }
+                if (e.key.code == sf::Keyboard::F5) {
+                    command([](Simulator& s) {
+                        if (!s.saveCheckpoint("checkpoint.esck")) std::cout << "Checkpoint save failed\n";
+                    });
+                }
+                if (e.key.code == sf::Keyboard::F9) {
+                    command([](Simulator& s) { // the view and Bz row follow the loaded Params
+                        if (!s.loadCheckpoint("checkpoint.esck")) std::cout << "Checkpoint load failed\n";
+                    });
+                }
+                if (e.key.code == sf::Keyboard::I) {                // integrator: Euler -> Boris (Bz) -> block timesteps
+                    command([](Simulator& s) {
+                        auto& in = s.params().integrator;
+                        in = (in == Simulator::Integrator::SymplecticEuler) ? Simulator::Integrator::Boris
+                           : (in == Simulator::Integrator::Boris)           ? Simulator::Integrator::BlockTimestep
+                                                                            : Simulator::Integrator::SymplecticEuler;
+                    });
+                }
+                if (e.key.code == sf::Keyboard::F) {                // field overlay: off -> potential -> |E|
+                    fieldView = (fieldView == FieldView::Off)       ? FieldView::Potential
+                              : (fieldView == FieldView::Potential) ? FieldView::Magnitude
+                                                                    : FieldView::Off;
+                    fieldStale = true;
+                }
+                if (e.key.code == sf::Keyboard::G) { fieldArrows = !fieldArrows; fieldStale = true; } // E arrows
+                if (e.key.code == sf::Keyboard::P) showProfile = !showProfile;                    // profiler HUD
+                if (e.key.code == sf::Keyboard::F2) dumpProfile("profile");                     // profile.csv/.json
+                if (e.key.code == sf::Keyboard::E) {                // energy / momentum graph
+                    showEnergy = !showEnergy;
+                    energyHist.clear();
+                    lastDiagStep = 0;
+                    command([on = showEnergy](Simulator& s) { s.setDiagnosticsEnabled(on); });
+                }
+                if (e.key.code == sf::Keyboard::K) {                // particle-particle collisions on/off
+                    command([](Simulator& s) { s.setCollisionsEnabled(!s.collisionsEnabled()); });
+                }
+                if (e.key.code == sf::Keyboard::W) {                // walls: off -> reflect -> periodic wrap
+                    command([](Simulator& s) {
+                        auto& wall = s.params().boundary;
+                        if (!s.boundsEnabled()) {
+                            s.setBoundsEnabled(true);
+                            wall = Simulator::Boundary::Reflect;
+                        } else if (wall == Simulator::Boundary::Reflect) {
+                            wall = Simulator::Boundary::Periodic;
+                        } else {
+                            s.setBoundsEnabled(false);
+                        }
+                    });
+                }
             }
 
             // Mouse wheel: adjust spawn charge magnitude (±0.2 µC steps, clamped)
@@ -193,18 +516,21 @@ int main() {
                     }
                 }
 
-                // Row 2: Bz (Tesla) — UI only for now
+                // Row 2: Bz (Tesla), applied by the Boris integrator
                 {
                     auto R = rowRect(2);
+                    auto applyBz = [&] { command([bz = uiBz](Simulator& s) { s.params().bz = bz; }); };
                     if (contains(R, mousePx)) {
                         if (contains(minusRect(R), mousePx)) { 
                             uiBz -= 0.05f;                              // step 0.05 T
                             if (uiBz < -2.0f) uiBz = -2.0f;             // clamp [-2, +2] T
+                            applyBz();
                             continue;
                         }
                         if (contains(plusRect(R), mousePx))  { 
                             uiBz += 0.05f;
                             if (uiBz >  2.0f) uiBz =  2.0f;
+                            applyBz();
                             continue;
                         }
                     }
@@ -219,49 +545,107 @@ int main() {
                 sf::Vector2f mouseM  = mousePx / ppm; // px -> meters
 
                 float q = (e.mouseButton.button == sf::Mouse::Left) ? +uiCharge : -uiCharge;
-                sf::Color col = (q > 0) ? sf::Color::Red : sf::Color::Blue;
+                Rgba8 col = (q > 0) ? Rgba8{255, 0, 0, 255} : Rgba8{0, 0, 255, 255}; // red / blue
 
-                sim.addParticle({ mouseM, {0.0f, 0.0f}, q, mass, radius, col });
+                const Particle p{ mouseM, {0.0f, 0.0f}, q, mass, radius, col };
+                command([p](Simulator& s) { s.addParticle(p); });
             }
         }
+        eventsSpan.stop();
 
 
         // ---- update (fixed dt) ----
+        prof::Scope updateSpan(&profiler, prof::Phase::Update);
         float frame = clock.restart().asSeconds();
 
-        if (paused) {
-            // Do NOT accumulate time while paused
+        if (physics || paused) {
+            // The physics thread paces itself; while paused do NOT accumulate time
             accTime = 0.0f;
         } else {
             // Accumulate, but cap how much we try to catch up this frame
             accTime += std::min(frame, 0.25f); // don't accumulate more than 0.25s per frame
 
             // Also cap the number of physics steps per frame to avoid spiral-of-death
-            int steps = 0, maxSteps = 240;     // at most ~0.5s of sim @ 1/480 dt, adjust as you like
-            while (accTime >= dt && steps < maxSteps) {
-                sim.step(dt);
-                accTime -= dt;
-                ++steps;
-            }
+            const int maxSteps = 240;          // at most ~0.5s of sim @ 1/480 dt, adjust as you like
+            const int steps = std::min(static_cast<int>(accTime / dt), maxSteps);
+            recorder.advance(sim, dt, steps);  // whole batch in one call (plain advance when not recording)
+            accTime -= steps * dt;
+            syncSteps += uint64_t(steps);
 
             // (Optional) if we hit the cap, drop leftover time
-            if (steps == maxSteps) accTime = 0.0f;
+            if (steps == maxSteps) { syncDropped += accTime; accTime = 0.0f; }
         }
+        updateSpan.stop();
 
 
         // ---- draw ----
+        prof::Scope drawSpan(&profiler, prof::Phase::Draw); // includes the field refresh
         window.clear(sf::Color::Black);
 
-        for (const auto& p : sim.particles()) {
-            // meters -> pixels
-            sf::Vector2f posPx = p.pos * ppm;
-            float rPx = std::max(2.0f, p.radius * ppm); // ensure visible
+        const Snapshot* snap = physics ? &physics->latest() : nullptr;
+
+        // Fit the view to loaded bounds and show the loaded Bz
+        {
+            const float bw = snap ? snap->boundsW : sim.params().boundsW;
+            const float bh = snap ? snap->boundsH : sim.params().boundsH;
+            const float bz = snap ? snap->bz : sim.params().bz;
+            if ((bw != seenW || bh != seenH) && (bw != askedW || bh != askedH)) {
+                worldW = askedW = bw;
+                worldH = askedH = bh;
+                ppm = std::min(W / worldW, H / worldH);
+            }
+            seenW = bw;
+            seenH = bh;
+            if (bz != seenBz) uiBz = seenBz = bz;
+        }
 
-            sf::CircleShape shape(rPx);
-            shape.setOrigin(rPx, rPx);
-            shape.setPosition(posPx);
-            shape.setFillColor(p.color);
-            window.draw(shape);
+        const uint64_t stepsNow = snap ? snap->steps : syncSteps;
+        const size_t particleCount = snap ? snap->size() : sim.size();
+        profiler.count(prof::Counter::StepsPerFrame, double(stepsNow - lastSteps));
+        profiler.count(prof::Counter::DroppedTime, physics ? physics->droppedTime() : syncDropped);
+        profiler.count(prof::Counter::Particles, double(particleCount));
+        lastSteps = stepsNow;
+
+        const StepDiagnostics& diag = snap ? snap->diag : sim.diagnostics();
+        if (showEnergy && diag.step != lastDiagStep) {
+            if (diag.step < lastDiagStep) energyHist.clear(); // diagnostics restarted
+            energyHist.push(diag);
+            lastDiagStep = diag.step;
+        }
+
+        // field overlay under the particles
+        if (fieldView != FieldView::Off || fieldArrows) {
+            prof::Scope fieldSpan(&profiler, prof::Phase::Field);
+            FieldMap::Config fc;
+            fc.cols = std::max(1u, W / 8);
+            fc.rows = std::max(1u, H / 8);
+            fc.boundsW = W / ppm;
+            fc.boundsH = H / ppm;
+            fc.k = snap ? snap->k : sim.params().k; // current Params: F9 loads may change them
+            fc.softening2 = snap ? snap->softening2 : sim.params().softening2;
+            fc.moveTolerance = 2.f / ppm; // 2 px
+            fc.minInterval = 10;
+            const bool fresh = snap
+                ? fieldMap.update(fc, snap->x.data(), snap->y.data(), snap->q.data(), snap->size(), fieldPool)
+                : fieldMap.update(fc, sim.store().x.data(), sim.store().y.data(), sim.store().q.data(),
+                                  sim.size(), fieldPool);
+            if (fresh || fieldStale) rebuildField();
+            fieldStale = false;
+            fieldSpan.stop();
+
+            if (fieldView != FieldView::Off) {
+                fieldSprite.setScale(fc.boundsW * ppm / fc.cols, fc.boundsH * ppm / fc.rows);
+                window.draw(fieldSprite);
+            }
+            if (fieldArrows) window.draw(fieldGlyphs);
+        }
+
+        // all particles, one or two draw calls
+        if (snap) {
+            renderer.draw(window, snap->x.data(), snap->y.data(), snap->radius.data(), snap->color.data(),
+                          snap->size(), ppm);
+        } else {
+            renderer.draw(window, sim.store(), ppm);
         }
 
         // (Optional) tiny cursor dot so you can see where you click
@@ -286,13 +670,99 @@ int main() {
             drawRow(0, "Charge (C)", fmt(uiCharge));
             drawRow(1, "Mass (kg)",  fmt(uiMass));
             drawRow(2, "Bz (T)",     fmt(uiBz));
+
+            // Profiler HUD right of "UI OK": rolling min / mean / p99 per phase (ms)
+            if (prof::kEnabled && showProfile) {
+                std::string names = "phase (ms)\n", mins = "min\n", means = "mean\n", p99s = "p99\n";
+                for (size_t i = 0; i < size_t(prof::Phase::Count); ++i) {
+                    const auto st = profiler.stats(prof::Phase(i));
+                    if (!st.samples) continue;
+                    char buf[32];
+                    names += prof::phaseName(prof::Phase(i)); names += '\n';
+                    std::snprintf(buf, sizeof(buf), "%.3f\n", st.minMs);  mins  += buf;
+                    std::snprintf(buf, sizeof(buf), "%.3f\n", st.meanMs); means += buf;
+                    std::snprintf(buf, sizeof(buf), "%.3f\n", st.p99Ms);  p99s  += buf;
+                }
+                char foot[128];
+                std::snprintf(foot, sizeof(foot), "steps/frame %.0f   dropped %.3f s   n %zu",
+                              profiler.latest(prof::Counter::StepsPerFrame),
+                              profiler.latest(prof::Counter::DroppedTime), particleCount);
+
+                const float x0 = 80.f;
+                const float cols[4] = { x0, x0 + 90.f, x0 + 150.f, x0 + 210.f };
+                const std::string* text[4] = { &names, &mins, &means, &p99s };
+                for (int c = 0; c < 4; ++c) {
+                    sf::Text t(*text[c], uiFont, 13);
+                    t.setFillColor(sf::Color(200,200,200));
+                    t.setPosition(cols[c], 12.f);
+                    window.draw(t);
+                }
+                const float lines = float(std::count(names.begin(), names.end(), '\n'));
+                sf::Text t(foot, uiFont, 13);
+                t.setFillColor(sf::Color(200,200,200));
+                t.setPosition(x0, 12.f + lines * 16.f);
+                window.draw(t);
+            }
         }
 
+        // Energy graph, bottom left: total energy relative to the oldest point
+        // in the window (yellow, symmetric scale) and |p| over its window max (cyan)
+        if (showEnergy && energyHist.size() > 1) {
+            const sf::FloatRect box(12.f, H - 132.f, 320.f, 120.f);
+            sf::RectangleShape bg({ box.width, box.height });
+            bg.setPosition(box.left, box.top);
+            bg.setFillColor(sf::Color(20, 20, 20, 200));
+            bg.setOutlineThickness(1.f);
+            bg.setOutlineColor(sf::Color(120,120,120));
+            window.draw(bg);
+
+            const size_t m = energyHist.size();
+            const double e0 = energyHist.front().total();
+            const double scale = std::fabs(e0) > 0.0 ? std::fabs(e0) : 1.0;
+            double dMax = 1e-9, pMax = 1e-30;
+            for (size_t i = 0; i < m; ++i) {
+                dMax = std::max(dMax, std::fabs(energyHist[i].total() - e0) / scale);
+                pMax = std::max(pMax, energyHist[i].momentum());
+            }
+            energyLine.clear();
+            momentumLine.clear();
+            const float midY = box.top + 0.5f * box.height, halfH = 0.45f * box.height;
+            for (size_t i = 0; i < m; ++i) {
+                const float x = box.left + box.width * float(i) / float(m - 1);
+                const double d = (energyHist[i].total() - e0) / scale;
+                energyLine.append(sf::Vertex({ x, midY - halfH * float(d / dMax) }, sf::Color(255, 220, 60)));
+                const double pm = energyHist[i].momentum() / pMax;
+                momentumLine.append(sf::Vertex({ x, box.top + box.height - 4.f - (box.height - 8.f) * float(pm) },
+                                               sf::Color(80, 200, 255)));
+            }
+            window.draw(momentumLine);
+            window.draw(energyLine);
+
+            if (uiFont.getInfo().family != "") {
+                const StepDiagnostics& last = energyHist.back();
+                char buf[192];
+                std::snprintf(buf, sizeof(buf), "E %.4g J  (K %.3g%s)  dE/|E| +-%.2g\n|p| %.3g kg m/s  clamps %u",
+                              last.total(), last.kinetic, last.hasPotential ? ", U incl." : ", no U",
+                              dMax, last.momentum(), last.clampHits);
+                sf::Text t(buf, uiFont, 12);
+                t.setFillColor(sf::Color(200,200,200));
+                t.setPosition(box.left + 4.f, box.top + 2.f);
+                window.draw(t);
+            }
+        }
+        drawSpan.stop();
+
         
 
 
-        window.display();
+        {
+            prof::Scope displaySpan(&profiler, prof::Phase::Display);
+            window.display();
+        }
     }
 
+    if (physics) physics->stop(); // the recorder must not be in use while it closes
+    recorder.close();
+    if (!profilePath.empty()) dumpProfile(profilePath);
     return 0;
 }
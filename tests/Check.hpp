@@ -0,0 +1,51 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "Simulator.hpp"
+
+// Minimal checks for the ctest executables: report the failing line and make
+// main() return non-zero.
+#define CHECK(cond)                                                               \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            return 1;                                                             \
+        }                                                                         \
+    } while (0)
+
+// Seeded neutral gas in the default 8 m x 6 m box (same as ElectroSim_bench)
+inline void fillGas(Simulator& sim, size_t n, unsigned seed, float speed = 0.1f) {
+    std::mt19937 rng(seed);
+    const auto& P = sim.params();
+    std::uniform_real_distribution<float> ux(0.f, P.boundsW), uy(0.f, P.boundsH), uv(-speed, speed);
+    for (size_t i = 0; i < n; ++i) {
+        const float q = (i & 1) ? 1e-7f : -1e-7f;
+        sim.addParticle({ { ux(rng), uy(rng) }, { uv(rng), uv(rng) }, q, 1e-3f, 0.01f });
+    }
+}
+
+// Kinetic plus softened pair potential (J), summed directly in double. O(N^2).
+inline double totalEnergy(const Simulator& sim) {
+    const ParticleStore& S = sim.store();
+    const auto& P = sim.params();
+    double e = 0.0;
+    for (size_t i = 0; i < S.size(); ++i) {
+        e += 0.5 * S.mass[i] * (double(S.vx[i]) * S.vx[i] + double(S.vy[i]) * S.vy[i]);
+        for (size_t j = i + 1; j < S.size(); ++j) {
+            const double rx = double(S.x[i]) - S.x[j], ry = double(S.y[i]) - S.y[j];
+            e += double(P.k) * S.q[i] * S.q[j] / std::sqrt(rx * rx + ry * ry + P.softening2);
+        }
+    }
+    return e;
+}
+
+// Two opposite charges on an eccentric orbit about the box centre; speed is
+// `f` times the circular orbit speed at separation r (m).
+inline void addBinary(Simulator& sim, float f, float r = 0.5f) {
+    const float q = 1e-6f, m = 1e-3f;
+    const float cx = 0.5f * sim.params().boundsW, cy = 0.5f * sim.params().boundsH;
+    const float v = f * std::sqrt(sim.params().k * q * q * (2.0f / m) / r); // relative speed
+    sim.addParticle({ { cx - 0.5f * r, cy }, { 0.f, -0.5f * v },  q, m, 0.01f });
+    sim.addParticle({ { cx + 0.5f * r, cy }, { 0.f,  0.5f * v }, -q, m, 0.01f });
+}
@@ -0,0 +1,51 @@
+// Boris push: a charge gyrating in a uniform Bz keeps its speed at large
+// q Bz dt / m, and with Bz = 0 the integrator tracks symplectic Euler to
+// rounding on an interacting gas.
+#include "Check.hpp"
+
+int main() {
+    const float dt = 1.0f / 240.0f;
+
+    // Gyration: q Bz dt / m = 0.5 rad per step (a coarse step)
+    {
+        Simulator::Params P;
+        P.integrator = Simulator::Integrator::Boris;
+        P.bz = 0.5f / dt; // T, with q / m = 1 C/kg below
+        P.threads = 1;
+        Simulator sim(P);
+        sim.setElectrostaticsEnabled(false);
+        sim.addParticle({ { 4.f, 3.f }, { 0.3f, 0.f }, 1e-3f, 1e-3f, 0.01f });
+        const double v0 = 0.3;
+        double worst = 0.0, rMax = 0.0;
+        for (int s = 0; s < 10000; ++s) {
+            sim.step(dt);
+            const Particle p = sim.particle(0);
+            worst = std::max(worst, std::fabs(std::hypot(double(p.vel.x), double(p.vel.y)) - v0) / v0);
+            rMax = std::max(rMax, double(std::hypot(p.pos.x - 4.f, p.pos.y - 3.f)));
+        }
+        std::printf("gyration: worst |v| error %.3g, max distance from start %.3g m\n", worst, rMax);
+        CHECK(worst < 1e-4); // float rounding only; Euler would ignore B entirely
+        CHECK(rMax < 0.1); // gyroradius v m / (q B) ~ 2.5 mm: bounded, no spiral out
+    }
+
+    // Bz = 0: same trajectories as SymplecticEuler up to rounding
+    {
+        Simulator::Params P;
+        P.softening2 = 0.05f * 0.05f;
+        P.maxAccel = 1e4f;
+        Simulator euler(P);
+        P.integrator = Simulator::Integrator::Boris;
+        Simulator boris(P);
+        fillGas(euler, 500, 9u);
+        fillGas(boris, 500, 9u);
+        euler.advance(dt, 60);
+        boris.advance(dt, 60);
+        float worst = 0.f;
+        for (size_t i = 0; i < 500; ++i)
+            worst = std::max(worst, std::hypot(euler.store().x[i] - boris.store().x[i],
+                                               euler.store().y[i] - boris.store().y[i]));
+        std::printf("Bz = 0: worst position difference vs symplectic Euler %.3g m\n", worst);
+        CHECK(worst < 1e-4f);
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Hard-disc contacts: elastic collisions in free flight keep total momentum
+// and kinetic energy, and the result does not depend on the thread count.
+#include "Check.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+struct Totals { double px = 0.0, py = 0.0, pabs = 0.0, ke = 0.0; }; // pabs = sum m|v|
+
+Totals totals(const ParticleStore& S) {
+    Totals t;
+    for (size_t i = 0; i < S.size(); ++i) {
+        const double m = S.mass[i], vx = S.vx[i], vy = S.vy[i];
+        t.px += m * vx;
+        t.py += m * vy;
+        t.pabs += m * std::hypot(vx, vy);
+        t.ke += 0.5 * m * (vx * vx + vy * vy);
+    }
+    return t;
+}
+
+} // namespace
+
+int main() {
+    Simulator::Params P;
+    P.restitution = 1.0f;
+    ParticleStore last;
+    for (unsigned threads : { 1u, 3u }) {
+        P.threads = threads;
+        Simulator sim(P);
+        sim.setElectrostaticsEnabled(false);
+        sim.setCollisionsEnabled(true);
+        fillGas(sim, 4000, 3u, 1.0f); // ~1 contact per particle per second
+
+        const Totals t0 = totals(sim.store());
+        size_t contacts = 0;
+        for (int s = 0; s < 120; ++s) {
+            sim.step(1.0f / 240.0f);
+            contacts += sim.collisionStats().contacts;
+        }
+        const Totals t1 = totals(sim.store());
+        const double dp = std::hypot(t1.px - t0.px, t1.py - t0.py) / t0.pabs;
+        std::printf("threads %u: %zu contacts, dp %.3g, dK/K %.3g\n", threads, contacts,
+                    dp, (t1.ke - t0.ke) / t0.ke);
+        CHECK(contacts > 100);
+        CHECK(dp < 1e-5);
+        CHECK(std::fabs(t1.ke - t0.ke) < 1e-4 * t0.ke);
+
+        const ParticleStore& S = sim.store();
+        if (threads != 1) {
+            CHECK(std::memcmp(S.x.data(), last.x.data(), S.size() * sizeof(float)) == 0);
+            CHECK(std::memcmp(S.vx.data(), last.vx.data(), S.size() * sizeof(float)) == 0);
+        }
+        last = S;
+    }
+    return 0;
+}
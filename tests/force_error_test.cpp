@@ -0,0 +1,29 @@
+// Simulator::measureForceError: exact for the naive solver, small for
+// Barnes–Hut at the default opening angle and shrinking with theta.
+#include "Check.hpp"
+
+int main() {
+    Simulator::Params P;
+    P.softening2 = 0.05f * 0.05f;
+    P.threads = 1;
+    Simulator sim(P);
+    fillGas(sim, 1999, 7u);
+
+    // n % maxSamples != 0 must not sample every row
+    const Simulator::ForceError naive = sim.measureForceError(1000);
+    CHECK(naive.samples == 1000);
+    CHECK(naive.rmsRel == 0.f && naive.maxRel == 0.f);
+
+    sim.params().solver = Simulator::Solver::BarnesHut;
+    float last = 1.f;
+    for (float theta : { 1.0f, 0.5f, 0.25f }) {
+        sim.params().theta = theta;
+        const Simulator::ForceError bh = sim.measureForceError(500);
+        std::printf("theta %.2f: rms %.3g max %.3g (%zu samples)\n", theta, bh.rmsRel, bh.maxRel, bh.samples);
+        CHECK(bh.samples <= 500);
+        CHECK(bh.rmsRel > 0.f && bh.rmsRel < last);
+        last = bh.rmsRel;
+    }
+    CHECK(last < 1e-2f); // theta 0.25
+    return 0;
+}
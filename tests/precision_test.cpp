@@ -0,0 +1,107 @@
+// Float / Mixed / Double: Double holds a binary's energy far tighter than
+// Float, Mixed and Double give the same bits on any thread count, a spawn
+// mid-run leaves the Double state of everyone else alone, and with contacts
+// and walls on every precision ends each step inside the box, with walls
+// timed under Phase::Bounds.
+#include "Check.hpp"
+#include <cstring>
+
+namespace {
+
+using Precision = Simulator::Precision;
+
+// Worst |E - E0| / |E0| from the diagnostics over a circular binary
+double binaryDrift(Precision pr) {
+    Simulator::Params P;
+    P.softening2 = 1e-6f;
+    P.maxAccel = 1e9f;
+    P.precision = pr;
+    P.threads = 1;
+    Simulator sim(P);
+    addBinary(sim, 1.0f);
+    sim.setDiagnosticsEnabled(true);
+    sim.advance(1.0f / 960.0f, 4000);
+    const DiagnosticsSeries& h = sim.diagnosticsHistory();
+    double worst = 0.0;
+    for (size_t k = 0; k < h.size(); ++k)
+        worst = std::max(worst, std::fabs(h[k].total() - h.front().total()) / std::fabs(h.front().total()));
+    return worst;
+}
+
+} // namespace
+
+int main() {
+    const double fl = binaryDrift(Precision::Float), dbl = binaryDrift(Precision::Double);
+    std::printf("circular binary, worst energy drift: float %.3g, double %.3g\n", fl, dbl);
+    CHECK(dbl < 0.1 * fl); // what is left is the integrator's O(dt^2) wobble
+
+    const float dt = 1.0f / 240.0f;
+    for (Precision pr : { Precision::Mixed, Precision::Double }) {
+        ParticleStore one;
+        for (unsigned threads : { 1u, 3u }) {
+            Simulator::Params P;
+            P.softening2 = 0.05f * 0.05f;
+            P.maxAccel = 1e4f;
+            P.precision = pr;
+            P.threads = threads;
+            Simulator sim(P);
+            fillGas(sim, 1500, 8u);
+            sim.advance(dt, 20);
+            if (threads == 1) { one = sim.store(); continue; }
+            CHECK(std::memcmp(one.x.data(), sim.store().x.data(), one.size() * sizeof(float)) == 0);
+            CHECK(std::memcmp(one.vx.data(), sim.store().vx.data(), one.size() * sizeof(float)) == 0);
+        }
+    }
+
+    // An uncharged spawn does not act on the gas, so unless the spawn dropped
+    // the others' doubles both runs follow the same trajectories
+    {
+        ParticleStore plain;
+        for (bool spawn : { false, true }) {
+            Simulator::Params P;
+            P.softening2 = 0.05f * 0.05f;
+            P.maxAccel = 1e4f;
+            P.precision = Precision::Double;
+            P.threads = 1;
+            Simulator sim(P);
+            fillGas(sim, 400, 9u);
+            sim.advance(dt, 30);
+            if (spawn) sim.addParticle({ { 0.1f, 0.1f }, { 0.f, 0.f }, 0.f, 1e-3f, 0.01f });
+            sim.advance(dt, 60);
+            if (!spawn) { plain = sim.store(); continue; }
+            CHECK(std::memcmp(plain.x.data(), sim.store().x.data(), plain.size() * sizeof(float)) == 0);
+            CHECK(std::memcmp(plain.vy.data(), sim.store().vy.data(), plain.size() * sizeof(float)) == 0);
+        }
+    }
+
+    // Contacts can push discs through a wall; the walls must act after them
+    for (Precision pr : { Precision::Float, Precision::Mixed, Precision::Double }) {
+        Simulator::Params P;
+        P.boundsW = 1.0f;
+        P.boundsH = 1.0f;
+        P.softening2 = 0.05f * 0.05f;
+        P.maxAccel = 1e4f;
+        P.restitution = 0.9f;
+        P.precision = pr;
+        Simulator sim(P);
+        sim.setBoundsEnabled(true);
+        sim.setCollisionsEnabled(true);
+        sim.setElectrostaticsEnabled(false);
+        fillGas(sim, 1500, 6u, 2.0f); // ~70% of the box covered by discs
+        prof::Profiler profiler;
+        sim.setProfiler(&profiler);
+        size_t outside = 0;
+        for (int s = 0; s < 60; ++s) {
+            sim.step(dt);
+            const ParticleStore& S = sim.store();
+            for (size_t i = 0; i < S.size(); ++i) {
+                const float r = S.radius[i];
+                outside += S.x[i] < r || S.x[i] > P.boundsW - r || S.y[i] < r || S.y[i] > P.boundsH - r;
+            }
+        }
+        std::printf("precision %d: %zu particle-steps outside the walls\n", int(pr), outside);
+        CHECK(outside == 0);
+        if constexpr (prof::kEnabled) CHECK(profiler.stats(prof::Phase::Bounds).samples == 60);
+    }
+    return 0;
+}
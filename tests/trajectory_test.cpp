@@ -0,0 +1,79 @@
+// Trajectory round trip: every recorded frame decodes to the simulated
+// positions, exactly at keyframes and within half a quantum in delta frames,
+// and a header whose index does not fit the file falls back to the frame chain.
+#include "Check.hpp"
+#include "Trajectory.hpp"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "electrosim_trajectory_test.estraj").string();
+    const float dt = 1.0f / 240.0f;
+    const int steps = 40;
+
+    Simulator::Params P;
+    P.softening2 = 0.05f * 0.05f;
+    P.solver = Simulator::Solver::BarnesHut;
+    P.integrator = Simulator::Integrator::Boris;
+    P.bz = 0.25f;
+    P.bzGradX = 0.01f;
+    P.bzGradY = -0.02f;
+    P.maxLevel = 4;
+    P.eta = 0.05f;
+    P.precision = Simulator::Precision::Mixed;
+    Simulator rec(P), ref(P);
+    for (Simulator* s : { &rec, &ref }) {
+        s->setBoundsEnabled(true);
+        fillGas(*s, 500, 11u, 0.5f);
+    }
+
+    TrajectoryWriter w;
+    TrajectoryWriter::Options o;
+    o.keyInterval = 8;
+    CHECK(w.open(path, P, dt, o));
+    w.advance(rec, dt, steps);
+    w.close();
+
+    TrajectoryReader r;
+    CHECK(r.open(path));
+    CHECK(r.frameCount() == size_t(steps) + 1); // start state plus one frame per step
+    const Simulator::Params Q = r.params();
+    CHECK(Q.solver == P.solver && Q.softening2 == P.softening2);
+    CHECK(Q.integrator == P.integrator && Q.maxLevel == P.maxLevel && Q.eta == P.eta);
+    CHECK(Q.bz == P.bz && Q.bzGradX == P.bzGradX && Q.bzGradY == P.bzGradY);
+    CHECK(Q.precision == P.precision);
+
+    const float tol = 0.5f * o.quantum + 4e-6f; // plus float rounding of key + d * quantum at ~8 m
+    for (size_t f = 0; f < r.frameCount(); ++f) {
+        if (f > 0) ref.step(dt);
+        const TrajectoryReader::Frame fr = r.frame(f);
+        const ParticleStore& S = ref.store();
+        CHECK(fr.n == S.size() && fr.step == f);
+        const bool key = f % o.keyInterval == 0;
+        float worst = 0.f;
+        for (size_t i = 0; i < fr.n; ++i) {
+            worst = std::max(worst, std::max(std::fabs(fr.x[i] - S.x[i]), std::fabs(fr.y[i] - S.y[i])));
+            CHECK(fr.radius[i] == S.radius[i]);
+        }
+        CHECK(key ? worst == 0.f : worst <= tol);
+    }
+    r.close();
+
+    // frameCount * sizeof(IndexEntry) wraps to 0: must not pass as an index
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        const uint64_t huge = uint64_t(1) << 60;
+        std::memcpy(bytes.data() + offsetof(traj::FileHeader, frameCount), &huge, sizeof(huge));
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), std::streamsize(bytes.size()));
+    }
+    CHECK(r.open(path));
+    CHECK(r.frameCount() == size_t(steps) + 1);
+    r.close();
+    std::filesystem::remove(path);
+    return 0;
+}